@@ -60,6 +60,7 @@ namespace gmp {
 #include <random>
 #include <cmath>
 #include <string>
+#include <thread>
 
 // ---- Timing ----
 
@@ -138,6 +139,17 @@ static void csv_row(const char* benchmark, size_t n1, size_t n2,
             benchmark, n1, n2, zint_ns, gmp_ns, zint_ns / gmp_ns);
 }
 
+// Serial vs parallel timings of zint itself go to their own file, so they
+// are never read as a zint vs GMP comparison.
+static FILE* parallel_csv_file = nullptr;
+
+static void parallel_csv_row(const char* benchmark, size_t n, unsigned threads,
+                             double serial_ns, double parallel_ns) {
+    if (!parallel_csv_file) return;
+    fprintf(parallel_csv_file, "%s,%zu,%u,%.1f,%.1f,%.4f\n",
+            benchmark, n, threads, serial_ns, parallel_ns, serial_ns / parallel_ns);
+}
+
 // ---- Console output ----
 
 static const char* fmt_ns(double ns) {
@@ -462,13 +474,49 @@ static void bench_from_string() {
     }
 }
 
+// Serial vs parallel primes in ntt::big_multiply (same binary, same data).
+// Rows go to the parallel CSV, not the GMP comparison.
+static void bench_parallel_primes() {
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned threads = hw < 3 ? 3 : hw;
+    printf("\n=== Parallel primes (big_multiply, %u threads) ===\n", threads);
+    printf("  %-20s  %12s  %12s  %8s\n", "Size", "1 thread", "parallel", "Speedup");
+    printf("  %-20s  %12s  %12s  %8s\n", "----", "--------", "--------", "-------");
+    auto sizes = gen_sizes(16384, 1048576, 2);
+
+    for (size_t n : sizes) {
+        printf("  benchmarking %zu x %zu...\r", n, n); fflush(stdout);
+        std::vector<uint64_t> ap(n), bp(n), rp(2 * n);
+        fill_random(ap.data(), n);
+        fill_random(bp.data(), n);
+
+        ntt::set_num_threads(1);
+        double t_ser = bench([&]{
+            ntt::big_multiply_u64(rp.data(), 2 * n, ap.data(), n, bp.data(), n);
+        });
+        ntt::set_num_threads(threads);
+        double t_par = bench([&]{
+            ntt::big_multiply_u64(rp.data(), 2 * n, ap.data(), n, bp.data(), n);
+        });
+        ntt::set_num_threads(1);
+
+        char label[32]; snprintf(label, sizeof(label), "%zu", n);
+        printf("  %-20s  %12s  %12s  %7.2fx\n",
+               label, fmt_ns(t_ser), fmt_ns(t_par), t_ser / t_par);
+        fflush(stdout);
+        parallel_csv_row("mul_parallel_primes", n, threads, t_ser, t_par);
+    }
+}
+
 // ============================================================
 // Main
 // ============================================================
 
 int main(int argc, char** argv) {
     const char* csv_path = "bench_results.csv";
+    const char* parallel_csv_path = "bench_parallel.csv";
     if (argc > 1) csv_path = argv[1];
+    if (argc > 2) parallel_csv_path = argv[2];
 
     csv_file = fopen(csv_path, "w");
     if (!csv_file) {
@@ -477,37 +525,49 @@ int main(int argc, char** argv) {
     }
     fprintf(csv_file, "benchmark,n1,n2,zint_ns,gmp_ns,ratio\n");
 
+    parallel_csv_file = fopen(parallel_csv_path, "w");
+    if (!parallel_csv_file) {
+        fprintf(stderr, "Cannot open %s for writing\n", parallel_csv_path);
+        fclose(csv_file);
+        return 1;
+    }
+    fprintf(parallel_csv_file, "benchmark,n,threads,serial_ns,parallel_ns,speedup\n");
+
     printf("zint vs GMP Extended Benchmark\n");
     printf("==============================\n");
     printf("Ratio < 1.00 = zint faster, > 1.00 = GMP faster\n");
-    printf("CSV output: %s\n", csv_path);
+    printf("CSV output: %s (parallel primes: %s)\n", csv_path, parallel_csv_path);
     fflush(stdout);
 
-    printf("\n[1/8] addmul_1...\n"); fflush(stdout);
+    printf("\n[1/9] addmul_1...\n"); fflush(stdout);
     bench_addmul_1();
 
-    printf("\n[2/8] Balanced multiply...\n"); fflush(stdout);
+    printf("\n[2/9] Balanced multiply...\n"); fflush(stdout);
     bench_balanced_mul();
 
-    printf("\n[3/8] Unbalanced multiply...\n"); fflush(stdout);
+    printf("\n[3/9] Unbalanced multiply...\n"); fflush(stdout);
     bench_unbalanced_mul();
 
-    printf("\n[4/8] Squaring...\n"); fflush(stdout);
+    printf("\n[4/9] Squaring...\n"); fflush(stdout);
     bench_squaring();
 
-    printf("\n[5/8] Division...\n"); fflush(stdout);
+    printf("\n[5/9] Division...\n"); fflush(stdout);
     bench_division();
 
-    printf("\n[6/8] BigInt multiply (full stack)...\n"); fflush(stdout);
+    printf("\n[6/9] BigInt multiply (full stack)...\n"); fflush(stdout);
     bench_bigint_mul();
 
-    printf("\n[7/8] to_string...\n"); fflush(stdout);
+    printf("\n[7/9] to_string...\n"); fflush(stdout);
     bench_to_string();
 
-    printf("\n[8/8] from_string...\n"); fflush(stdout);
+    printf("\n[8/9] from_string...\n"); fflush(stdout);
     bench_from_string();
 
+    printf("\n[9/9] Parallel primes...\n"); fflush(stdout);
+    bench_parallel_primes();
+
+    fclose(parallel_csv_file);
     fclose(csv_file);
-    printf("\n=== DONE === Results in %s\n", csv_path);
+    printf("\n=== DONE === Results in %s and %s\n", csv_path, parallel_csv_path);
     return 0;
 }
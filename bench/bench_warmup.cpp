@@ -0,0 +1,96 @@
+// bench_warmup.cpp - First-call latency with and without ntt::warmup
+//
+// Each measurement runs in a fresh process (the program re-runs itself), so
+// "cold" really is the first product of the process.  Reported per size:
+// the first product cold, the first product after warmup(limbs), the steady
+// state (best of later calls) and the time warmup itself took, each the
+// median over TRIALS processes.
+//
+// Build:
+//   g++ -std=c++17 -O2 -march=native -I. -pthread bench/bench_warmup.cpp -o bench_warmup
+
+#include "ntt/api.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using u64 = std::uint64_t;
+
+static constexpr int TRIALS = 7;
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Child: optional warmup, then the first product and the steady state.
+static int child(std::size_t n, bool warm) {
+    std::mt19937_64 rng(n);
+    std::vector<u64> a(n), b(n), out(2 * n);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+
+    double t_warm = 0;
+    if (warm) {
+        auto t0 = std::chrono::steady_clock::now();
+        ntt::warmup(n);
+        t_warm = seconds_since(t0);
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    ntt::big_multiply_u64(out.data(), 2 * n, a.data(), n, b.data(), n);
+    const double t_first = seconds_since(t0);
+
+    double t_steady = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        t0 = std::chrono::steady_clock::now();
+        ntt::big_multiply_u64(out.data(), 2 * n, a.data(), n, b.data(), n);
+        const double t = seconds_since(t0);
+        if (t < t_steady) t_steady = t;
+    }
+    printf("%.9f %.9f %.9f\n", t_first, t_steady, t_warm);
+    return 0;
+}
+
+static bool run_child(const char* self, std::size_t n, bool warm,
+                      double& first, double& steady, double& t_warm) {
+    const std::string cmd = std::string("\"") + self + "\" child " +
+                            std::to_string(n) + (warm ? " warm" : " cold");
+    FILE* p = popen(cmd.c_str(), "r");
+    if (!p) return false;
+    const bool ok = fscanf(p, "%lf %lf %lf", &first, &steady, &t_warm) == 3;
+    return pclose(p) == 0 && ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::string(argv[1]) == "child")
+        return child(std::strtoull(argv[2], nullptr, 10), std::string(argv[3]) == "warm");
+
+    printf("=== first-call latency, cold vs after ntt::warmup (ms) ===\n");
+    printf("  %-9s %10s %10s %10s %10s\n", "limbs", "cold", "warmed", "steady", "warmup");
+    auto median = [](std::vector<double>& v) {
+        std::sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    };
+    for (std::size_t n : {512, 4096, 65536, 524288, 4194304}) {
+        std::vector<double> cold, warmed, steady, t_warm;
+        for (int t = 0; t < TRIALS; ++t) {
+            double c, w, s, tw, unused;
+            if (!run_child(argv[0], n, false, c, s, unused) ||
+                !run_child(argv[0], n, true, w, unused, tw)) {
+                printf("  %-9zu child failed\n", n);
+                return 1;
+            }
+            cold.push_back(c);
+            warmed.push_back(w);
+            steady.push_back(s);
+            t_warm.push_back(tw);
+        }
+        printf("  %-9zu %10.3f %10.3f %10.3f %10.3f\n", n, median(cold) * 1e3,
+               median(warmed) * 1e3, median(steady) * 1e3, median(t_warm) * 1e3);
+    }
+    return 0;
+}
@@ -519,7 +519,6 @@ public:
 private:
     static constexpr limb_t POW10_18 = 1000000000000000000ULL; // 10^18
     static constexpr int    DIG10_18 = 18;
-    static constexpr uint32_t RADIX_DC_THRESHOLD = 30; // limbs: D&C above this
 
     // ---- Power-of-10 cache: 10^(2^k) for k = 0, 1, 2, ... ----
     struct pow10_entry { limb_t* data; uint32_t size; };
@@ -624,6 +623,7 @@ private:
     std::string to_decimal_string() const {
         uint32_t nn = abs_size();
         if (nn == 0) return "0";
+        ntt::ProfileScope ps(ntt::PROF_BI_TO_STRING);
 
         bigint tmp = this->abs();
         std::string result;
@@ -690,6 +690,7 @@ private:
     static bigint from_decimal_string(const char* s, bool neg) {
         size_t len = std::strlen(s);
         if (len == 0) return bigint();
+        ntt::ProfileScope ps(ntt::PROF_BI_FROM_STRING);
 
         // Skip leading zeros
         while (len > 1 && *s == '0') { s++; len--; }
@@ -11,12 +11,6 @@
 
 namespace bi {
 
-// ============================================================
-// Tuning thresholds
-// ============================================================
-
-static constexpr uint32_t DIV_DC_THRESHOLD = 60;  // schoolbook -> D&C/Newton
-
 // ============================================================
 // Schoolbook division (Knuth Algorithm D)
 // ============================================================
@@ -127,8 +121,6 @@ static void mpn_div_qr_schoolbook(limb_t* qp, limb_t* np, uint32_t nn,
 // Newton reciprocal inversion
 // ============================================================
 
-static constexpr uint32_t INVERT_THRESHOLD = 32;
-
 // Compute ip[0..dn) such that (B^dn + ip) ≈ floor(B^(2*dn) / D)
 // D = dp[0..dn) must be normalized (dp[dn-1] has MSB set).
 // Result may be off by ±2.
@@ -164,44 +156,68 @@ static void mpn_newton_invert(limb_t* ip, const limb_t* dp, uint32_t dn)
     mpn_newton_invert(ip + l, dp + l, h);
     // V_h = B^h + ip[l..dn)
 
-    // Step 2: T = D * V_h = D * I_h + D * B^h
-    limb_t* tp = mpn_alloc(dn + h + 2);
-    mpn_mul(tp, dp, dn, ip + l, h);   // tp[0..dn+h)
-    tp[dn + h] = 0;
-    limb_t carry = mpn_add_n(tp + h, tp + h, dp, dn);
-    tp[dn + h] += carry;
-    // T = tp[0..dn+h+1), T[dn+h] ∈ {0, 1}, T ≈ B^(dn+h)
+    // V_h = B^h + ip[l..dn)
+    limb_t* vh = mpn_alloc(h + 1);
+    mpn_copyi(vh, ip + l, h);
+    vh[h] = 1;
 
-    // Step 3: err = B^(dn+h) - T (signed)
+    // Step 2-3: err = B^(dn+h) - T (signed), T = D * V_h ≈ B^(dn+h)
     bool err_neg;
-    limb_t* err = mpn_alloc(dn + h);
-    if (tp[dn + h] == 0) {
-        // T < B^(dn+h), err > 0: negate T (two's complement)
-        err_neg = false;
-        limb_t c = 1;
-        for (uint32_t i = 0; i < dn + h; i++) {
-            unsigned char cc = _addcarry_u64(0, ~tp[i], c, (unsigned long long*)&err[i]);
-            c = cc;
+    limb_t* err;
+    uint32_t err_cap;
+    uint32_t m = mpn_mulmod_bnm1_next_size(dn + 1);
+    if (dn >= MULMOD_BNM1_THRESHOLD && m < dn + h) {
+        // |err| < 5*B^dn: V_h is within a few units of B^(2h) / D_h, with
+        // D_h = dp[l..dn), and dp[0..l) adds less than 2*B^dn.  So err is
+        // recovered from W = T mod (B^m - 1), m > dn, as the residue of
+        // B^(dn+h) - W = B^k - W nearest to zero.
+        uint32_t k = dn + h - m;
+        err = mpn_alloc(m);
+        err_cap = m;
+        mpn_mulmod_bnm1(err, m, dp, dn, vh, h + 1);
+        for (uint32_t i = 0; i < m; i++) err[i] = ~err[i];   // (B^m - 1) - W
+        if (mpn_add_1(err + k, err + k, m - k, 1))
+            mpn_add_1(err, err, m, 1);                       // end-around carry
+        err_neg = (err[m - 1] >> 63) != 0;
+        if (err_neg) {
+            // err = e - (B^m - 1): |err| = ~e
+            for (uint32_t i = 0; i < m; i++) err[i] = ~err[i];
         }
     } else {
-        // T >= B^(dn+h), err < 0: |err| = T[0..dn+h)
-        err_neg = true;
-        mpn_copyi(err, tp, dn + h);
+        limb_t* tp = mpn_alloc(dn + h + 2);
+        mpn_mul(tp, dp, dn, ip + l, h);   // tp[0..dn+h)
+        tp[dn + h] = 0;
+        limb_t carry = mpn_add_n(tp + h, tp + h, dp, dn);
+        tp[dn + h] += carry;
+        // T = tp[0..dn+h+1), T[dn+h] ∈ {0, 1}
+
+        err = mpn_alloc(dn + h);
+        err_cap = dn + h;
+        if (tp[dn + h] == 0) {
+            // T < B^(dn+h), err > 0: negate T (two's complement)
+            err_neg = false;
+            limb_t c = 1;
+            for (uint32_t i = 0; i < dn + h; i++) {
+                unsigned char cc = _addcarry_u64(0, ~tp[i], c, (unsigned long long*)&err[i]);
+                c = cc;
+            }
+        } else {
+            // T >= B^(dn+h), err < 0: |err| = T[0..dn+h)
+            err_neg = true;
+            mpn_copyi(err, tp, dn + h);
+        }
+        mpn_free(tp);
     }
-    mpn_free(tp);
 
-    uint32_t err_n = mpn_normalize(err, dn + h);
+    uint32_t err_n = mpn_normalize(err, err_cap);
     if (err_n == 0) {
         mpn_zero(ip, l);
+        mpn_free(vh);
         mpn_free(err);
         return;
     }
 
     // Step 4: correction = V_h * |err| / B^(2h)
-    limb_t* vh = mpn_alloc(h + 1);
-    mpn_copyi(vh, ip + l, h);
-    vh[h] = 1;
-
     uint32_t prod_n = (h + 1) + err_n;
     limb_t* prod = mpn_alloc(prod_n);
     if (h + 1 >= err_n)
@@ -285,17 +301,39 @@ static void newton_div_block(limb_t* qp, limb_t* np, uint32_t wn,
     // Q_est might be off by a few. Compute remainder = np - Q_est * D.
     uint32_t qn_norm = mpn_normalize(q_est, this_qn + 1);
     if (qn_norm > 0) {
-        uint32_t prod_n = qn_norm + dn;
-        limb_t* prod = mpn_alloc(prod_n + 1);
-        prod[prod_n] = 0;
-        if (qn_norm >= dn)
-            mpn_mul(prod, q_est, qn_norm, d, dn);
-        else
-            mpn_mul(prod, d, dn, q_est, qn_norm);
-
-        uint32_t sn = (prod_n <= wn) ? prod_n : wn;
-        limb_t borrow = mpn_sub(np, np, wn, prod, sn);
-        mpn_free(prod);
+        limb_t borrow;
+        uint32_t m = mpn_mulmod_bnm1_next_size(dn + 1);
+        if (dn >= MULMOD_BNM1_THRESHOLD && m < qn_norm + dn) {
+            // |np - Q_est * D| < 6*D < B^(dn+1) / 2, so the remainder is the
+            // residue mod B^m - 1 (m > dn) nearest to zero: a cyclic product
+            // of m limbs instead of the full qn_norm + dn.  m <= wn here.
+            limb_t* w = mpn_alloc(m);
+            limb_t* r = mpn_alloc(m);
+            mpn_mulmod_bnm1(w, m, q_est, qn_norm, d, dn);
+            mpn_bnm1_fold(r, m, np, wn);
+            if (mpn_sub_n(r, r, w, m))
+                mpn_sub_1(r, r, m, 1);                       // end-around borrow
+            // Negative: e - (B^m - 1) is e + 1 in m-limb two's complement
+            // (e = B^m - 1 is zero)
+            borrow = 0;
+            if (r[m - 1] >> 63) borrow = !mpn_add_1(r, r, m, 1);
+            mpn_copyi(np, r, m);
+            for (uint32_t i = m; i < wn; i++) np[i] = borrow ? ~(limb_t)0 : 0;
+            mpn_free(r);
+            mpn_free(w);
+        } else {
+            uint32_t prod_n = qn_norm + dn;
+            limb_t* prod = mpn_alloc(prod_n + 1);
+            prod[prod_n] = 0;
+            if (qn_norm >= dn)
+                mpn_mul(prod, q_est, qn_norm, d, dn);
+            else
+                mpn_mul(prod, d, dn, q_est, qn_norm);
+
+            uint32_t sn = (prod_n <= wn) ? prod_n : wn;
+            borrow = mpn_sub(np, np, wn, prod, sn);
+            mpn_free(prod);
+        }
 
         // Adjust Q down while remainder negative
         for (int adj = 0; adj < 5 && borrow; adj++) {
@@ -393,8 +431,10 @@ inline void mpn_div_qr(limb_t* qp, limb_t* np, uint32_t nn,
     }
 
     if (dn < DIV_DC_THRESHOLD) {
+        ntt::ProfileScope ps(ntt::PROF_BI_DIV_SCHOOLBOOK);
         mpn_div_qr_schoolbook(qp, np, nn, dp, dn);
     } else {
+        ntt::ProfileScope ps(ntt::PROF_BI_DIV_NEWTON);
         mpn_div_qr_newton(qp, np, nn, dp, dn);
     }
 }
@@ -9,6 +9,8 @@
 #include <cstring>
 #include <cassert>
 
+#include "../ntt/common.hpp"   // aligned_alloc_bytes (huge pages for large arrays)
+
 #ifdef _MSC_VER
 #include <intrin.h>
 #pragma intrinsic(_addcarry_u64, _subborrow_u64, _umul128, _BitScanReverse64, _udiv128)
@@ -328,20 +330,12 @@ inline limb_t* mpn_alloc(uint32_t n) {
     size_t bytes = (size_t)n * sizeof(limb_t);
     // Round up to alignment
     bytes = (bytes + ALLOC_ALIGN - 1) & ~(ALLOC_ALIGN - 1);
-#ifdef _MSC_VER
-    return static_cast<limb_t*>(_aligned_malloc(bytes, ALLOC_ALIGN));
-#else
-    return static_cast<limb_t*>(std::aligned_alloc(ALLOC_ALIGN, bytes));
-#endif
+    return static_cast<limb_t*>(ntt::aligned_alloc_bytes(bytes, ALLOC_ALIGN));
 }
 
 inline void mpn_free(limb_t* p) {
     if (!p) return;
-#ifdef _MSC_VER
-    _aligned_free(p);
-#else
-    std::free(p);
-#endif
+    ntt::aligned_free_bytes(p);
 }
 
 } // namespace bi
@@ -5,6 +5,7 @@
 // NTT bridge uses ntt/p50x4 engine via ntt::big_multiply_u64().
 
 #include "mpn.hpp"
+#include "tuning.hpp"
 #include <cstring>
 #include <algorithm>
 
@@ -13,20 +14,6 @@
 
 namespace bi {
 
-// ============================================================
-// Tuning thresholds (determined by benchmarking)
-// ============================================================
-
-// Below this, use schoolbook basecase
-static constexpr uint32_t KARATSUBA_THRESHOLD = 32;
-
-// Below this, use Karatsuba; above, use NTT
-static constexpr uint32_t NTT_THRESHOLD = 1024;
-
-// For squaring, thresholds can be different (squaring is ~1.5x faster)
-static constexpr uint32_t SQR_KARATSUBA_THRESHOLD = 40;
-static constexpr uint32_t SQR_NTT_THRESHOLD = 1024;
-
 // ============================================================
 // Basecase multiplication (schoolbook)
 // ============================================================
@@ -297,6 +284,7 @@ static void mpn_mul_karatsuba(limb_t* rp, const limb_t* ap, uint32_t an,
 inline void mpn_mul_ntt(limb_t* rp, const limb_t* ap, uint32_t an,
                          const limb_t* bp, uint32_t bn)
 {
+    ntt::ProfileScope ps(ntt::PROF_BI_NTT);
     ntt::big_multiply_u64(rp, (ntt::idt)(an + bn), ap, (ntt::idt)an, bp, (ntt::idt)bn);
 }
 
@@ -317,6 +305,7 @@ inline void mpn_mul(limb_t* rp, const limb_t* ap, uint32_t an,
         // Use NTT when the larger operand is NTT-sized
         mpn_mul_ntt(rp, ap, an, bp, bn);
     } else if (bn < NTT_THRESHOLD) {
+        ntt::ProfileScope ps(ntt::PROF_BI_KARATSUBA);
         uint32_t mx = an > bn ? an : bn;
         uint32_t scratch_n = 6 * mx + 128;
         limb_t* scratch = mpn_alloc(scratch_n);
@@ -335,6 +324,7 @@ inline void mpn_sqr(limb_t* rp, const limb_t* ap, uint32_t n) {
         mpn_sqr_basecase(rp, ap, n);
     } else if (n < SQR_NTT_THRESHOLD) {
         // Use Karatsuba for squaring (same algorithm, a == b)
+        ntt::ProfileScope ps(ntt::PROF_BI_KARATSUBA);
         uint32_t scratch_n = 6 * n + 128;
         limb_t* scratch = mpn_alloc(scratch_n);
         mpn_mul_karatsuba_n(rp, ap, ap, n, scratch);
@@ -344,4 +334,172 @@ inline void mpn_sqr(limb_t* rp, const limb_t* ap, uint32_t n) {
     }
 }
 
+// ============================================================
+// Short products
+// ============================================================
+//
+// Below KARATSUBA_THRESHOLD the schoolbook loops skip the partial products
+// that cannot reach the wanted half.  In the Karatsuba range they use
+// Mulders' split: one full product of k = n - 3n/10 limbs plus two short
+// products of the remaining n - k limbs for the cross terms.  From
+// NTT_THRESHOLD on they call the NTT short products.
+
+// rp[0..n) = (ap[0..n) * bp[0..n)) mod B^n
+inline void mpn_mullo_basecase(limb_t* rp, const limb_t* ap, const limb_t* bp, uint32_t n) {
+    mpn_mul_1(rp, ap, n, bp[0]);
+    for (uint32_t j = 1; j < n; j++)
+        mpn_addmul_1(rp + j, ap, n - j, bp[j]);
+}
+
+// rp[0..n) = (ap[0..n) * bp[0..n)) mod B^n, exact.
+// rp does not alias ap or bp.
+inline void mpn_mullo_n(limb_t* rp, const limb_t* ap, const limb_t* bp, uint32_t n) {
+    assert(n > 0);
+
+    if (n < KARATSUBA_THRESHOLD) {
+        mpn_mullo_basecase(rp, ap, bp, n);
+        return;
+    }
+    if (n >= NTT_THRESHOLD) {
+        ntt::big_mullo_u64(rp, (ntt::idt)n, ap, (ntt::idt)n, bp, (ntt::idt)n);
+        return;
+    }
+
+    // a = a1*B^k + a0, b = b1*B^k + b0:
+    // ab mod B^n = a0*b0 + ((a1*b0 + a0*b1) mod B^h) * B^k
+    uint32_t h = n * 3 / 10;
+    uint32_t k = n - h;
+    limb_t* t = mpn_alloc(2 * k);
+    mpn_mul(t, ap, k, bp, k);
+    mpn_copyi(rp, t, n);
+    mpn_mullo_n(t, ap + k, bp, h);
+    mpn_add_n(rp + k, rp + k, t, h);
+    mpn_mullo_n(t, bp + k, ap, h);
+    mpn_add_n(rp + k, rp + k, t, h);
+    mpn_free(t);
+}
+
+// rp[0..2n) = S with S <= ap*bp < S + n*B^n: the low half is only a
+// by-product, the high half is within n of the true one.
+static void mpn_mulhi_approx(limb_t* rp, const limb_t* ap, const limb_t* bp, uint32_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        // Partial products on diagonals i + j >= n - 2 only; the omitted
+        // ones sum to less than B^n.
+        mpn_zero(rp, 2 * n);
+        for (uint32_t j = 0; j < n; j++) {
+            uint32_t i0 = (j + 2 < n) ? n - 2 - j : 0;
+            rp[n + j] = mpn_addmul_1(rp + i0 + j, ap + i0, n - i0, bp[j]);
+        }
+        return;
+    }
+
+    // a = a1*B^l + a0 with a1 of k limbs, same for b:
+    //   S = a1*b1*B^(2l) + approx(top l of a1 * b0) * B^k + (same for b1*a0)
+    // Omitted: a0*b0 < B^(2l) <= B^n, the low k-l limbs of a1 (b1) times b0
+    // (a0), each < B^n, and twice the recursive error; by induction the total
+    // stays below n*B^n.
+    uint32_t l = n * 3 / 10;
+    uint32_t k = n - l;
+    mpn_zero(rp, 2 * l);
+    mpn_mul(rp + 2 * l, ap + l, k, bp + l, k);
+    limb_t* t = mpn_alloc(2 * l);
+    mpn_mulhi_approx(t, ap + k, bp, l);
+    mpn_add(rp + k, rp + k, 2 * n - k, t, 2 * l);
+    mpn_mulhi_approx(t, bp + k, ap, l);
+    mpn_add(rp + k, rp + k, 2 * n - k, t, 2 * l);
+    mpn_free(t);
+}
+
+// rp[0..n) approximates H = floor(ap[0..n) * bp[0..n) / B^n), the high half
+// of the product: H - e <= rp <= H, where e = 1 below KARATSUBA_THRESHOLD and
+// from NTT_THRESHOLD on, and e = n in between.
+// rp does not alias ap or bp.
+inline void mpn_mulhi_n(limb_t* rp, const limb_t* ap, const limb_t* bp, uint32_t n) {
+    assert(n > 0);
+
+    if (n >= NTT_THRESHOLD) {
+        ntt::big_mulhi_u64(rp, (ntt::idt)n, ap, (ntt::idt)n, bp, (ntt::idt)n);
+        return;
+    }
+    limb_t* t = mpn_alloc(2 * n);
+    mpn_mulhi_approx(t, ap, bp, n);
+    mpn_copyi(rp, t + n, n);
+    mpn_free(t);
+}
+
+// ============================================================
+// Wraparound products mod B^rn - 1
+// ============================================================
+//
+// Since B^rn == 1, a product mod B^rn - 1 is a cyclic convolution of rn
+// limbs: about half the transform of the full product when the operands are
+// rn/2 .. rn limbs each.  Newton iterations (div.hpp) use it for products
+// whose value is known up to a deviation far below B^rn / 2, which the
+// residue then determines.
+
+// rp[0..rn) = ap[0..an) mod (B^rn - 1).  Precondition: an >= rn.
+static void mpn_bnm1_fold(limb_t* rp, uint32_t rn, const limb_t* ap, uint32_t an) {
+    mpn_copyi(rp, ap, rn);
+    limb_t cy = 0;
+    for (uint32_t i = rn; i < an; i += rn) {
+        uint32_t len = (an - i < rn) ? an - i : rn;
+        cy += mpn_add(rp, rp, rn, ap + i, len);
+    }
+    while (cy) cy = mpn_add_1(rp, rp, rn, cy);
+}
+
+// Smallest rn' >= rn at which mpn_mulmod_bnm1 runs as one cyclic transform.
+inline uint32_t mpn_mulmod_bnm1_next_size(uint32_t rn) {
+    if (rn < MULMOD_BNM1_THRESHOLD) return rn;
+    return (uint32_t)ntt::mulmod_bnm1_size((ntt::idt)rn);
+}
+
+// rp[0..rn) = ap[0..an) * bp[0..bn) mod (B^rn - 1).
+// Operands longer than rn are folded first.  A zero residue may come out as
+// B^rn - 1 (all ones).  Any rn works; sizes from mpn_mulmod_bnm1_next_size
+// are the fast ones.
+// Precondition: rn, an, bn > 0; rp does not alias ap or bp
+inline void mpn_mulmod_bnm1(limb_t* rp, uint32_t rn, const limb_t* ap, uint32_t an,
+                            const limb_t* bp, uint32_t bn)
+{
+    assert(rn > 0 && an > 0 && bn > 0);
+
+    limb_t* fa = nullptr;
+    limb_t* fb = nullptr;
+    if (an > rn) {
+        fa = mpn_alloc(rn);
+        mpn_bnm1_fold(fa, rn, ap, an);
+        ap = fa;
+        an = mpn_normalize(fa, rn);
+    }
+    if (bn > rn) {
+        fb = mpn_alloc(rn);
+        mpn_bnm1_fold(fb, rn, bp, bn);
+        bp = fb;
+        bn = mpn_normalize(fb, rn);
+    }
+    if (an < bn) {
+        std::swap(ap, bp);
+        std::swap(an, bn);
+    }
+
+    if (bn == 0) {
+        mpn_zero(rp, rn);
+    } else if (an + bn <= rn) {
+        // Nothing wraps
+        mpn_mul(rp, ap, an, bp, bn);
+        if (an + bn < rn) mpn_zero(rp + an + bn, rn - an - bn);
+    } else if (rn < MULMOD_BNM1_THRESHOLD) {
+        limb_t* t = mpn_alloc(an + bn);
+        mpn_mul(t, ap, an, bp, bn);
+        mpn_bnm1_fold(rp, rn, t, an + bn);
+        mpn_free(t);
+    } else {
+        ntt::big_mulmod_bnm1_u64(rp, (ntt::idt)rn, ap, (ntt::idt)an, bp, (ntt::idt)bn);
+    }
+
+    if (fb) mpn_free(fb);
+    if (fa) mpn_free(fa);
+}
+
 } // namespace bi
@@ -0,0 +1,84 @@
+#pragma once
+// tuning.hpp - Crossover thresholds of the bi:: dispatch
+//
+// The defaults below were measured on one Zen 4 machine.  tune_bigint.cpp
+// measures each crossover on the current machine and prints a header of
+// BI_*_THRESHOLD macros; saved as bigint/tuning_local.hpp it is picked up
+// here and overrides the defaults.  Any single macro can also be set on the
+// command line (-DBI_NTT_THRESHOLD=1500).
+//
+// Building with BI_TUNE_PROGRAM turns the thresholds into mutable variables
+// so the tuner can move them at run time; everywhere else they stay
+// constexpr and the dispatch compiles to the same code as before.
+
+#include <cstdint>
+
+#if defined(__has_include)
+#if __has_include("tuning_local.hpp")
+#include "tuning_local.hpp"
+#endif
+#endif
+
+#ifndef BI_KARATSUBA_THRESHOLD
+#define BI_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BI_NTT_THRESHOLD
+#define BI_NTT_THRESHOLD 1024
+#endif
+#ifndef BI_SQR_KARATSUBA_THRESHOLD
+#define BI_SQR_KARATSUBA_THRESHOLD 40
+#endif
+#ifndef BI_SQR_NTT_THRESHOLD
+#define BI_SQR_NTT_THRESHOLD 1024
+#endif
+#ifndef BI_MULMOD_BNM1_THRESHOLD
+#define BI_MULMOD_BNM1_THRESHOLD 1024
+#endif
+#ifndef BI_DIV_DC_THRESHOLD
+#define BI_DIV_DC_THRESHOLD 60
+#endif
+#ifndef BI_INVERT_THRESHOLD
+#define BI_INVERT_THRESHOLD 32
+#endif
+#ifndef BI_RADIX_DC_THRESHOLD
+#define BI_RADIX_DC_THRESHOLD 30
+#endif
+
+#ifdef BI_TUNE_PROGRAM
+#define BI_TUNABLE static inline uint32_t
+#else
+#define BI_TUNABLE static constexpr uint32_t
+#endif
+
+namespace bi {
+
+// Below this, use schoolbook basecase
+BI_TUNABLE KARATSUBA_THRESHOLD = BI_KARATSUBA_THRESHOLD;
+
+// Below this, use Karatsuba; above, use NTT
+BI_TUNABLE NTT_THRESHOLD = BI_NTT_THRESHOLD;
+
+// For squaring, thresholds can be different (squaring is ~1.5x faster)
+BI_TUNABLE SQR_KARATSUBA_THRESHOLD = BI_SQR_KARATSUBA_THRESHOLD;
+BI_TUNABLE SQR_NTT_THRESHOLD = BI_SQR_NTT_THRESHOLD;
+
+// Below this, mpn_mulmod_bnm1 computes the full product and folds it
+BI_TUNABLE MULMOD_BNM1_THRESHOLD = BI_MULMOD_BNM1_THRESHOLD;
+
+// Divisor limbs: schoolbook -> D&C/Newton
+BI_TUNABLE DIV_DC_THRESHOLD = BI_DIV_DC_THRESHOLD;
+
+// Newton reciprocal: schoolbook base case at or below this many limbs
+BI_TUNABLE INVERT_THRESHOLD = BI_INVERT_THRESHOLD;
+
+// Radix conversion: D&C above this many limbs (18 * this many digits)
+BI_TUNABLE RADIX_DC_THRESHOLD = BI_RADIX_DC_THRESHOLD;
+
+#ifndef BI_TUNE_PROGRAM
+static_assert(KARATSUBA_THRESHOLD >= 4 && SQR_KARATSUBA_THRESHOLD >= 4,
+              "Karatsuba thresholds below 4 limbs are not supported");
+static_assert(INVERT_THRESHOLD >= 1 && RADIX_DC_THRESHOLD >= 1,
+              "empty base cases are not supported");
+#endif
+
+} // namespace bi
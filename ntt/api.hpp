@@ -11,27 +11,51 @@
 #include "p30x3/crt.hpp"
 #include "arena.hpp"
 #include "profile.hpp"
+#include "thread_pool.hpp"
 #include "p50x4/multiply.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace ntt {
 
+// Conditional-subtract constants taking a u32 to [0, 2*Mod): 8*Mod and
+// 4*Mod are used only when they fit in 32 bits (0 = skip that step).
+template<u32 Mod>
+struct ReduceConsts {
+    static constexpr u64 MAX32 = 0xFFFFFFFFULL;
+    static constexpr u32 Mod2 = u32(2ULL * Mod);
+    static constexpr u32 Mod4 = (4ULL * Mod <= MAX32) ? u32(4ULL * Mod) : 0;
+    static constexpr u32 Mod8 = (8ULL * Mod <= MAX32) ? u32(8ULL * Mod) : 0;
+};
+
+template<typename B, u32 Mod>
+NTT_FORCEINLINE typename B::Vec reduce_vec(typename B::Vec x) {
+    using C = ReduceConsts<Mod>;
+    if constexpr (C::Mod8 != 0) x = B::min32(x, B::sub32(x, B::broadcast(C::Mod8)));
+    if constexpr (C::Mod4 != 0) x = B::min32(x, B::sub32(x, B::broadcast(C::Mod4)));
+    return B::min32(x, B::sub32(x, B::broadcast(C::Mod2)));
+}
+
+template<u32 Mod>
+NTT_FORCEINLINE u32 reduce_scalar(u32 v) {
+    using C = ReduceConsts<Mod>;
+    if constexpr (C::Mod8 != 0) { if (v >= C::Mod8) v -= C::Mod8; }
+    if constexpr (C::Mod4 != 0) { if (v >= C::Mod4) v -= C::Mod4; }
+    if (v >= C::Mod2) v -= C::Mod2;
+    return v;
+}
+
 // Reduce src[0..src_len) to [0, 2*Mod) and zero-pad buf[src_len..N).
 // Single-pass: loadu from src, reduce, store to aligned buf. One memory pass.
 template<typename B, u32 Mod>
 inline void reduce_and_pad(u32* buf, const u32* src, idt src_len, idt N) {
     using Vec = typename B::Vec;
 
-    constexpr u64 MAX32 = 0xFFFFFFFFULL;
-    constexpr u32 Mod2 = u32(2ULL * Mod);
-    constexpr u32 Mod4 = (4ULL * Mod <= MAX32) ? u32(4ULL * Mod) : 0;
-    constexpr u32 Mod8 = (8ULL * Mod <= MAX32) ? u32(8ULL * Mod) : 0;
-
-    const Vec vMod2 = B::broadcast(Mod2);
-    [[maybe_unused]] const Vec vMod4 = B::broadcast(Mod4);
-    [[maybe_unused]] const Vec vMod8 = B::broadcast(Mod8);
-
     const idt nvecs = src_len / B::LANES;
     idt j = 0;
     for (; j + 4 <= nvecs; j += 4) {
@@ -39,134 +63,522 @@ inline void reduce_and_pad(u32* buf, const u32* src, idt src_len, idt N) {
         Vec x1 = B::loadu(src + (j + 1) * B::LANES);
         Vec x2 = B::loadu(src + (j + 2) * B::LANES);
         Vec x3 = B::loadu(src + (j + 3) * B::LANES);
-        if constexpr (Mod8 != 0) {
-            x0 = B::min32(x0, B::sub32(x0, vMod8));
-            x1 = B::min32(x1, B::sub32(x1, vMod8));
-            x2 = B::min32(x2, B::sub32(x2, vMod8));
-            x3 = B::min32(x3, B::sub32(x3, vMod8));
-        }
-        if constexpr (Mod4 != 0) {
-            x0 = B::min32(x0, B::sub32(x0, vMod4));
-            x1 = B::min32(x1, B::sub32(x1, vMod4));
-            x2 = B::min32(x2, B::sub32(x2, vMod4));
-            x3 = B::min32(x3, B::sub32(x3, vMod4));
-        }
-        x0 = B::min32(x0, B::sub32(x0, vMod2));
-        x1 = B::min32(x1, B::sub32(x1, vMod2));
-        x2 = B::min32(x2, B::sub32(x2, vMod2));
-        x3 = B::min32(x3, B::sub32(x3, vMod2));
         Vec* d = (Vec*)buf + j;
-        B::store(d, x0);
-        B::store(d + 1, x1);
-        B::store(d + 2, x2);
-        B::store(d + 3, x3);
+        B::store(d, reduce_vec<B, Mod>(x0));
+        B::store(d + 1, reduce_vec<B, Mod>(x1));
+        B::store(d + 2, reduce_vec<B, Mod>(x2));
+        B::store(d + 3, reduce_vec<B, Mod>(x3));
     }
-    for (; j < nvecs; ++j) {
+    for (; j < nvecs; ++j)
+        B::store((Vec*)buf + j, reduce_vec<B, Mod>(B::loadu(src + j * B::LANES)));
+    // Scalar tail
+    for (idt i = nvecs * B::LANES; i < src_len; ++i)
+        buf[i] = reduce_scalar<Mod>(src[i]);
+    std::memset(buf + src_len, 0, (N - src_len) * sizeof(u32));
+}
+
+// reduce_and_pad for all three p30x3 primes at once: src is read once and
+// each load is reduced into buf0 (CRT_P0), buf1 (CRT_P1) and buf2 (CRT_P2).
+template<typename B>
+inline void reduce_and_pad3(u32* buf0, u32* buf1, u32* buf2,
+                            const u32* src, idt src_len, idt N) {
+    using Vec = typename B::Vec;
+
+    const idt nvecs = src_len / B::LANES;
+    Vec* d0 = (Vec*)buf0;
+    Vec* d1 = (Vec*)buf1;
+    Vec* d2 = (Vec*)buf2;
+    idt j = 0;
+    for (; j + 2 <= nvecs; j += 2) {
+        Vec x0 = B::loadu(src + (j) * B::LANES);
+        Vec x1 = B::loadu(src + (j + 1) * B::LANES);
+        B::store(d0 + j,     reduce_vec<B, CRT_P0>(x0));
+        B::store(d0 + j + 1, reduce_vec<B, CRT_P0>(x1));
+        B::store(d1 + j,     reduce_vec<B, CRT_P1>(x0));
+        B::store(d1 + j + 1, reduce_vec<B, CRT_P1>(x1));
+        B::store(d2 + j,     reduce_vec<B, CRT_P2>(x0));
+        B::store(d2 + j + 1, reduce_vec<B, CRT_P2>(x1));
+    }
+    if (j < nvecs) {
         Vec x = B::loadu(src + j * B::LANES);
-        if constexpr (Mod8 != 0) x = B::min32(x, B::sub32(x, vMod8));
-        if constexpr (Mod4 != 0) x = B::min32(x, B::sub32(x, vMod4));
-        x = B::min32(x, B::sub32(x, vMod2));
-        B::store((Vec*)buf + j, x);
+        B::store(d0 + j, reduce_vec<B, CRT_P0>(x));
+        B::store(d1 + j, reduce_vec<B, CRT_P1>(x));
+        B::store(d2 + j, reduce_vec<B, CRT_P2>(x));
     }
-    // Scalar tail
     for (idt i = nvecs * B::LANES; i < src_len; ++i) {
-        u32 v = src[i];
-        if constexpr (Mod8 != 0) { if (v >= Mod8) v -= Mod8; }
-        if constexpr (Mod4 != 0) { if (v >= Mod4) v -= Mod4; }
-        if (v >= Mod2) v -= Mod2;
-        buf[i] = v;
+        const u32 v = src[i];
+        buf0[i] = reduce_scalar<CRT_P0>(v);
+        buf1[i] = reduce_scalar<CRT_P1>(v);
+        buf2[i] = reduce_scalar<CRT_P2>(v);
     }
-    std::memset(buf + src_len, 0, (N - src_len) * sizeof(u32));
+    const std::size_t pad = (N - src_len) * sizeof(u32);
+    std::memset(buf0 + src_len, 0, pad);
+    std::memset(buf1 + src_len, 0, pad);
+    std::memset(buf2 + src_len, 0, pad);
 }
 
+// Vecs holding the first len u32 elements.
+template<typename B>
+inline idt live_vecs(idt len) { return (len + B::LANES - 1) / B::LANES; }
+
 // Run NTT convolution for one prime: forward, multiply, inverse
+// threads > 1 splits each transform across the pool.
+// f already holds a[0..na) reduced by reduce_and_pad3.  b == nullptr squares
+// a; otherwise g holds b already reduced when b_ready, else b is reduced into
+// g here.  The transforms are pruned: inputs are padded only to a whole Vec,
+// and the inverse produces only the first out_vecs Vecs of the product.
+// A single-threaded power-of-2 transform longer than the product is
+// truncated to tft_length Vecs: the forwards and the pointwise products stop
+// there and inverse_tft recovers the product from them.
 template<typename B, u32 Mod>
 inline void ntt_conv_one_prime(
-    u32* f, u32* g, idt ntt_vecs,
-    const u32* a, idt na, const u32* b, idt nb, idt N)
+    u32* f, u32* g, idt ntt_vecs, idt na,
+    const u32* b, idt nb, idt out_vecs, bool b_ready,
+    unsigned threads = 1)
 {
     using Vec = typename B::Vec;
     using S = NTTScheduler<B, Mod>;
 
-    bool is_sqr = (a == b && na == nb);
-    {
-        ProfileScope ps(&profile_counters().api_reduce_pad_ns);
-        reduce_and_pad<B, Mod>(f, a, na, N);
-        if (!is_sqr) reduce_and_pad<B, Mod>(g, b, nb, N);
+    const bool is_sqr = (b == nullptr);
+    const idt la = live_vecs<B>(na), lb = live_vecs<B>(nb);
+    const idt need = tft_length(ntt_vecs, (std::max)(out_vecs, live_vecs<B>(na + nb)));
+    const bool tft = (threads <= 1 || ntt_vecs < S::PARALLEL_MIN_VECS) &&
+                     need < ntt_vecs && (ntt_vecs & (ntt_vecs - 1)) == 0;
+    const idt keep = tft ? need : ntt_vecs;
+    if (!is_sqr && !b_ready) {
+        ProfileScope ps(PROF_API_REDUCE_PAD);
+        reduce_and_pad<B, Mod>(g, b, nb, lb * B::LANES);
     }
     {
-        ProfileScope ps(&profile_counters().api_forward_ns);
-        S::forward((Vec*)f, ntt_vecs);
-        if (!is_sqr) S::forward((Vec*)g, ntt_vecs);
+        ProfileScope ps(PROF_API_FORWARD);
+        S::forward((Vec*)f, ntt_vecs, threads, la, keep);
+        if (!is_sqr) S::forward((Vec*)g, ntt_vecs, threads, lb, keep);
     }
     {
-        if (is_sqr) std::memcpy(g, f, N * sizeof(u32));
-        ProfileScope ps(&profile_counters().api_freqmul_ns);
-        S::freq_multiply((Vec*)f, (Vec*)g, ntt_vecs);
+        if (is_sqr) std::memcpy(g, f, keep * sizeof(Vec));
+        ProfileScope ps(PROF_API_FREQMUL);
+        S::freq_multiply((Vec*)f, (Vec*)g, ntt_vecs, threads, keep);
     }
     {
-        ProfileScope ps(&profile_counters().api_inverse_ns);
-        S::inverse((Vec*)f, ntt_vecs);
+        ProfileScope ps(PROF_API_INVERSE);
+        if (tft) S::inverse_tft((Vec*)f, ntt_vecs, need, true);
+        else     S::inverse((Vec*)f, ntt_vecs, threads, out_vecs, true);
     }
 }
 
-// Three-prime NTT-based big integer multiplication.
-// Input: a[0..na), b[0..nb) are arrays of u32 limbs (base 2^32).
-// Output: out[0..out_len) is the product (at least na+nb limbs needed).
-inline void big_multiply(
+// Below this NTT size (u32 elements) the three primes always run serially:
+// thread hand-off costs more than one prime's convolution.
+static constexpr idt PARALLEL_PRIMES_MIN_NTT = idt(1) << 16;
+
+// Smallest SMOOTH_TABLE size >= x usable with backend B: whole Vecs, at
+// least 8 of them, and radix-3/5 sub-transforms of at least 4 Vecs (the
+// batch width of twisted_conv).
+template<typename B>
+inline idt ntt_size_for(idt x) {
+    idt N = ceil_smooth(x > 64 ? x : 64);
+    for (;;) {
+        const idt v = N / B::LANES;
+        if (N % B::LANES == 0 && v >= 8 && (idt(1) << ntt_ctzll(v)) >= 4) return N;
+        N = ceil_smooth(N + 1);
+    }
+}
+
+// ── Engine cost model ──
+//
+// Estimated time of one product as transform length times its log, in units
+// of a p30x3 element; a p50x4 element (four double transforms) costs
+// P50X4_COST of them.  Measured 3.6-5.6 with AVX-512 for 1M-12M limb
+// operands, so in practice the 31-bit path wins wherever it fits.
+static constexpr double P50X4_COST = 3.5;
+
+// A mixed-radix length pays extra for its outer radix-3/5/15 pass: measured
+// 1.1-1.35x the rate of a power of 2 with AVX-512 below 2^23 elements, and
+// about 1.0x above, where every length is bound by its passes over memory.
+static constexpr double MIXED_RADIX_COST = 1.15;
+
+inline double ntt_cost(idt n) {
+    const double c = double(n) * nbits_nz(n);
+    return ((n & (n - 1)) != 0 && n < (idt(1) << 23)) ? c * MIXED_RADIX_COST : c;
+}
+
+// Cost of a product of x elements at length N.  A power of 2 past the
+// product whose transforms run on one thread is truncated
+// (ntt_conv_one_prime): its tft_length share plus 1/8 for the extra passes
+// of inverse_tft, measured 0.09-0.13 with AVX-512 at 2^21-2^22 elements.
+template<typename B>
+inline double product_cost(idt x, idt N, unsigned threads) {
+    const idt v = N / B::LANES;
+    if ((v & (v - 1)) != 0 ||
+        (threads > 1 && v >= NTTScheduler<B, CRT_P0>::PARALLEL_MIN_VECS))
+        return ntt_cost(N);
+    const idt need = tft_length(v, live_vecs<B>(x));
+    if (need == v) return ntt_cost(N);
+    return ntt_cost(N) * (double(need) / double(v) + 0.125);
+}
+
+// Transform length for a plain product of x elements whose transforms at
+// length N run on threads_for(N) threads: ntt_size_for<B>(x), or the next
+// power of 2 when its truncated transform rates cheaper.  With the
+// mixed-radix premium of ntt_cost that is the case over much of
+// (4*2^k, 6*2^k] too, so the cost tracks x more closely than the steps
+// between 4/5/6/8 * 2^k (up to 25%) would.
+template<typename B, typename F>
+inline idt product_size_for(idt x, F&& threads_for) {
+    const idt N = ntt_size_for<B>(x);
+    const idt P = ceil_pow2(N);
+    if (P == N || ceil_smooth(P) != P) return N;
+    return product_cost<B>(x, P, threads_for(P)) < ntt_cost(N) ? P : N;
+}
+
+// Threads each transform of conv_three_primes at N elements runs on.
+inline unsigned conv_transform_threads(idt N) {
+    const unsigned threads = num_threads();
+    return (threads > 1 && N >= PARALLEL_PRIMES_MIN_NTT) ? (threads + 2) / 3 : 1;
+}
+
+// ── Low-memory mode (opt-in, set_low_memory in common.hpp) ──
+//
+// big_multiply normally keeps all three primes' results and a g-buffer
+// alive until the CRT.  In low-memory mode the primes run one after another
+// and each result is folded into an incremental Garner accumulation as soon
+// as it is done, so scratch drops from four transform buffers to two plus
+// one u32 per product limb.  The primes then never run concurrently; each
+// transform is still split over num_threads().  p50x4 likewise keeps its
+// primes sequential, sharing one b buffer instead of four.
+
+// big_multiply_with in low-memory mode.  r0 is kept in out itself unless out
+// overlaps an input that the later primes still read.
+template<typename B>
+inline void big_multiply_low_memory(
     u32* out, idt out_len,
     const u32* a, idt na,
-    const u32* b, idt nb)
+    const u32* b, idt nb, idt skip = 0)
 {
-    ProfileScope ps_total(&profile_counters().api_total_ns);
+    ProfileScope ps_total(PROF_API_TOTAL);
 
-    using B = Avx2;
-    using Vec = typename B::Vec;
+    const idt min_len = na + nb;
+    const idt N = product_size_for<B>(min_len, [](idt) { return num_threads(); });
+    const idt ntt_vecs = N / B::LANES;
+    const idt result_len = (std::min)(min_len - (std::min)(skip, min_len), out_len);
+    const idt out_vecs = live_vecs<B>(skip + result_len);
+    const idt pad_a = live_vecs<B>(na) * B::LANES;
+    const unsigned threads = num_threads();
+    const u32* bs = (a == b && na == nb) ? nullptr : b;
+
+    auto overlaps = [&](const u32* p, idt n) {
+        const uintptr_t o = reinterpret_cast<uintptr_t>(out);
+        const uintptr_t q = reinterpret_cast<uintptr_t>(p);
+        return n && o < q + n * sizeof(u32) && q < o + result_len * sizeof(u32);
+    };
+    const bool r0_in_out = !overlaps(a, na) && !overlaps(b, nb);
+
+    // Accumulator: v1, plus r0 when it cannot live in out
+    NTTArena& arena = NTTArena::instance();
+    const idt acc_len = ceil_smooth((std::max)(result_len, idt(64)));
+    u32* f = arena.alloc<u32>(N);
+    u32* g = arena.alloc<u32>(N);
+    u32* v1 = arena.alloc<u32>(acc_len);
+    u32* r0s = r0_in_out ? nullptr : arena.alloc<u32>(acc_len);
+    auto* rf = NTTArena::raw(f);
+    auto* rg = NTTArena::raw(g);
+    auto* rv1 = NTTArena::raw(v1);
+    u32* r0 = r0_in_out ? out : NTTArena::raw(r0s);
+
+    auto reduce_a = [&](auto red) {
+        ProfileScope ps(PROF_API_REDUCE_PAD);
+        red(rf, a, na, pad_a);
+    };
+
+    reduce_a(reduce_and_pad<B, CRT_P0>);
+    ntt_conv_one_prime<B, CRT_P0>(rf, rg, ntt_vecs, na, bs, nb, out_vecs, false, threads);
+    std::memcpy(r0, rf + skip, result_len * sizeof(u32));
+
+    reduce_a(reduce_and_pad<B, CRT_P1>);
+    ntt_conv_one_prime<B, CRT_P1>(rf, rg, ntt_vecs, na, bs, nb, out_vecs, false, threads);
+    {
+        ProfileScope ps(PROF_API_CRT);
+        crt_garner_v1(rv1, result_len, r0, rf + skip);
+    }
+
+    reduce_a(reduce_and_pad<B, CRT_P2>);
+    ntt_conv_one_prime<B, CRT_P2>(rf, rg, ntt_vecs, na, bs, nb, out_vecs, false, threads);
+    {
+        ProfileScope ps(PROF_API_CRT);
+        crt_and_propagate_v1(out, result_len, r0, rv1, rf + skip);
+    }
+
+    if (r0s) arena.dealloc(r0s, acc_len);
+    arena.dealloc(v1, acc_len);
+    arena.dealloc(g, N);
+    arena.dealloc(f, N);
+}
+
+// The three convolutions of a * b at transform length N (u32 elements, from
+// ntt_size_for<B>): leaves the lazy residues of the first out_vecs Vecs of
+// the product in rf0, rf1, rf2 (each N elements).  a is reduced for all
+// three primes in one pass; with num_threads() > 1 and N >=
+// PARALLEL_PRIMES_MIN_NTT the primes run concurrently.
+template<typename B>
+inline void conv_three_primes(
+    u32* rf0, u32* rf1, u32* rf2,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt N, idt out_vecs)
+{
+
+    const idt ntt_vecs = N / B::LANES;
 
+    const unsigned threads = num_threads();
+    const bool parallel = threads > 1 && N >= PARALLEL_PRIMES_MIN_NTT;
+
+    // g-buffers: one shared when serial, one per prime when parallel
+    NTTArena& arena = NTTArena::instance();
+
+    const bool is_sqr = (a == b && na == nb);
+    const u32* bs = is_sqr ? nullptr : b;
+    {
+        ProfileScope ps(PROF_API_REDUCE_PAD);
+        reduce_and_pad3<B>(rf0, rf1, rf2, a, na, live_vecs<B>(na) * B::LANES);
+    }
+
+    if (parallel) {
+        // One g per prime, so b is also reduced for all three in one pass
+        u32* g[3];
+        u32* rg[3];
+        for (int p = 0; p < 3; ++p) {
+            g[p] = arena.alloc<u32>(N);
+            rg[p] = NTTArena::raw(g[p]);
+        }
+        if (!is_sqr) {
+            ProfileScope ps(PROF_API_REDUCE_PAD);
+            reduce_and_pad3<B>(rg[0], rg[1], rg[2], b, nb, live_vecs<B>(nb) * B::LANES);
+        }
+        const unsigned per_prime = conv_transform_threads(N);
+        ThreadPool::instance().parallel_for(3, threads, [&](idt p) {
+            if (p == 0)
+                ntt_conv_one_prime<B, CRT_P0>(rf0, rg[0], ntt_vecs, na, bs, nb, out_vecs,
+                                              true, per_prime);
+            else if (p == 1)
+                ntt_conv_one_prime<B, CRT_P1>(rf1, rg[1], ntt_vecs, na, bs, nb, out_vecs,
+                                              true, per_prime);
+            else
+                ntt_conv_one_prime<B, CRT_P2>(rf2, rg[2], ntt_vecs, na, bs, nb, out_vecs,
+                                              true, per_prime);
+        });
+        for (int p = 2; p >= 0; --p) arena.dealloc(g[p], N);
+    } else {
+        u32* g = arena.alloc<u32>(N);
+        auto* rg = NTTArena::raw(g);
+
+        ntt_conv_one_prime<B, CRT_P0>(rf0, rg, ntt_vecs, na, bs, nb, out_vecs, false);
+        ntt_conv_one_prime<B, CRT_P1>(rf1, rg, ntt_vecs, na, bs, nb, out_vecs, false);
+        ntt_conv_one_prime<B, CRT_P2>(rf2, rg, ntt_vecs, na, bs, nb, out_vecs, false);
+
+        arena.dealloc(g, N);
+    }
+}
+
+// The body of big_multiply_with for a given transform length N (u32
+// elements, from ntt_size_for<B>).  The convolution is cyclic, so when
+// na + nb > N the product limbs at and above N wrap around onto the low ones
+// (big_mulmod_bnm1_u64 relies on this).  Returns the carry out of the last
+// output limb.
+template<typename B>
+inline u64 multiply_at_size(
+    u32* out, idt out_len,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt N, idt skip)
+{
     const idt min_len = na + nb;
-    idt N = ceil_smooth(min_len > 64 ? min_len : 64);
-    idt ntt_vecs = N / B::LANES;
-    if (ntt_vecs < 8) { ntt_vecs = 8; N = ntt_vecs * B::LANES; }
+    const idt result_len = (std::min)(min_len - (std::min)(skip, min_len), out_len);
 
-    // Pool: 4 buffers (3 f-buffers for CRT + 1 shared g-buffer)
+    // Pool: 3 f-buffers for CRT
     NTTArena& arena = NTTArena::instance();
 
     // Tagged pointers (2 bits encode bin offset for recycling)
-    Vec* f0 = arena.alloc<Vec>(ntt_vecs);
-    Vec* f1 = arena.alloc<Vec>(ntt_vecs);
-    Vec* f2 = arena.alloc<Vec>(ntt_vecs);
-    Vec* g  = arena.alloc<Vec>(ntt_vecs);
+    u32* f0 = arena.alloc<u32>(N);
+    u32* f1 = arena.alloc<u32>(N);
+    u32* f2 = arena.alloc<u32>(N);
 
     // Raw pointers for computation
     auto* rf0 = NTTArena::raw(f0);
     auto* rf1 = NTTArena::raw(f1);
     auto* rf2 = NTTArena::raw(f2);
-    auto* rg  = NTTArena::raw(g);
 
-    ntt_conv_one_prime<B, CRT_P0>((u32*)rf0, (u32*)rg, ntt_vecs, a, na, b, nb, N);
-    ntt_conv_one_prime<B, CRT_P1>((u32*)rf1, (u32*)rg, ntt_vecs, a, na, b, nb, N);
-    ntt_conv_one_prime<B, CRT_P2>((u32*)rf2, (u32*)rg, ntt_vecs, a, na, b, nb, N);
+    conv_three_primes<B>(rf0, rf1, rf2, a, na, b, nb, N, live_vecs<B>(skip + result_len));
 
-    idt result_len = (std::min)(min_len, out_len);
+    u64 carry;
     {
-        ProfileScope ps(&profile_counters().api_crt_ns);
-        crt_and_propagate(out, result_len, (u32*)rf0, (u32*)rf1, (u32*)rf2);
+        ProfileScope ps(PROF_API_CRT);
+        carry = crt_and_propagate(out, result_len, rf0 + skip, rf1 + skip, rf2 + skip);
     }
 
     // Return tagged pointers to arena (tag tells it the actual bin)
-    arena.dealloc(g,  ntt_vecs);
-    arena.dealloc(f2, ntt_vecs);
-    arena.dealloc(f1, ntt_vecs);
-    arena.dealloc(f0, ntt_vecs);
+    arena.dealloc(f2, N);
+    arena.dealloc(f1, N);
+    arena.dealloc(f0, N);
+    return carry;
+}
+
+// Three-prime NTT-based big integer multiplication on SIMD backend B.
+// Input: a[0..na), b[0..nb) are arrays of u32 limbs (base 2^32).
+// Output: out[0..out_len) is the product (at least na+nb limbs needed).
+// A shorter out_len yields the low out_len limbs (a short product: the
+// inverse transforms and the CRT stop there).  skip > 0 instead starts the
+// output at product limb skip, dropping the carry out of the limbs below, so
+// out is at most that carry less than the true limbs [skip, skip + out_len).
+// a (and, when each prime has its own g-buffer, b) is reduced for all three
+// primes in a single pass.  With num_threads() > 1 and N >=
+// PARALLEL_PRIMES_MIN_NTT the three primes run concurrently, each with a
+// private g-buffer, and the remaining threads are shared out to split each
+// prime's transforms.  See set_low_memory() for the low-memory variant.
+template<typename B>
+inline void big_multiply_with(
+    u32* out, idt out_len,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt skip = 0)
+{
+    if (low_memory()) {
+        big_multiply_low_memory<B>(out, out_len, a, na, b, nb, skip);
+        return;
+    }
+    ProfileScope ps_total(PROF_API_TOTAL);
+    multiply_at_size<B>(out, out_len, a, na, b, nb,
+                        product_size_for<B>(na + nb, conv_transform_threads), skip);
 }
 
-// Max p30x3 NTT size in u32 elements: 3*2^22 = 12582912
-static constexpr idt P30X3_MAX_NTT = 12582912;
+// Below this product length (u32 limbs) big_multiply stays on AVX2 even
+// when AVX-512 is available: small transforms gain little from 16 lanes.
+static constexpr idt AVX512_MIN_NTT = idt(1) << 12;
+
+// big_multiply_with on the widest backend this build and CPU support:
+// AVX-512 when compiled in (NTT_HAS_AVX512) and cpu_has_avx512f(), else AVX2.
+inline void big_multiply(
+    u32* out, idt out_len,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt skip = 0)
+{
+#ifdef NTT_HAS_AVX512
+    if (na + nb >= AVX512_MIN_NTT && cpu_has_avx512f()) {
+        big_multiply_with<Avx512>(out, out_len, a, na, b, nb, skip);
+        return;
+    }
+#endif
+    big_multiply_with<Avx2>(out, out_len, a, na, b, nb, skip);
+}
+
+// floor((P0*P1*P2 - 1) / (2^32 - 1)^2): a convolution of u32 limbs is exact
+// while each coefficient sums at most this many products.
+static constexpr idt P30X3_CRT_LIMIT = 13608000;
+
+// Max p30x3 NTT size in u32 elements for a plain product: 3*2^23 = 25165824.
+// A product coefficient sums min(na, nb) <= N/2 terms, within the CRT limit.
+static constexpr idt P30X3_MAX_NTT = 25165824;
+
+// Half that, 3*2^22 = 12582912, for convolutions whose coefficients may sum
+// up to N terms (wraparound products, poly_mul_mod_u64's cross terms).
+static constexpr idt P30X3_MAX_CYCLIC_NTT = 12582912;
+
+// Largest p30x3 transform, the last SMOOTH_TABLE entry: 3*2^24 = 50331648.
+// Usable by products with min(na, nb) <= P30X3_CRT_LIMIT u32 limbs, and by
+// big_multiply_narrow.
+static constexpr idt P30X3_MAX_NTT_ANY = 50331648;
+
+// ── Narrow-coefficient products (u64 limbs) ──
+//
+// Once both operands are past P30X3_CRT_LIMIT u32 limbs, their u32 limbs no
+// longer fit the CRT, but 31-bit pieces do: a coefficient is then below
+// (N/2) * 2^62 <= 2^86.6 < P0*P1*P2 at every size up to P30X3_MAX_NTT_ANY.
+// The operands are cut into 31-bit pieces, convolved, and recombined in base
+// 2^31 by crt_and_propagate_bits; the transforms are 32/31 longer than with
+// u32 limbs.
+static constexpr int NARROW_BITS = 31;
+
+// Number of NARROW_BITS-bit pieces in n u64 limbs
+inline idt narrow_len(idt n) {
+    return cdiv(64 * n, idt(NARROW_BITS));
+}
+
+// dst[0..n) = the NARROW_BITS-bit pieces of src[0..ns), least significant
+// first (zero past the top of src).
+inline void unpack_narrow(u32* dst, idt n, const u64* src, idt ns) {
+    constexpr u64 mask = (u64(1) << NARROW_BITS) - 1;
+    for (idt k = 0; k < n; ++k) {
+        const idt pos = k * NARROW_BITS;
+        const idt i = pos >> 6;
+        const int off = int(pos & 63);
+        u64 v = (i < ns) ? src[i] >> off : 0;
+        if (off > 64 - NARROW_BITS && i + 1 < ns) v |= src[i + 1] << (64 - off);
+        dst[k] = u32(v & mask);
+    }
+}
+
+template<typename B>
+inline void big_multiply_narrow_with(
+    u64* out, idt out_len,
+    const u64* a, idt na,
+    const u64* b, idt nb)
+{
+    ProfileScope ps_total(PROF_API_TOTAL);
+
+    const bool is_sqr = (a == b && na == nb);
+    const idt ca = narrow_len(na), cb = narrow_len(nb);
+    const idt N = product_size_for<B>(ca + cb, conv_transform_threads);
+    assert(N <= P30X3_MAX_NTT_ANY);
+    // Pieces at and above narrow_len(out_len) lie past the output
+    const idt len = (std::min)(ca + cb - 1, narrow_len(out_len));
+
+    u32* ua = aligned_alloc_array<u32, 64>(ca);
+    u32* ub = is_sqr ? ua : aligned_alloc_array<u32, 64>(cb);
+    {
+        ProfileScope ps(PROF_API_REDUCE_PAD);
+        unpack_narrow(ua, ca, a, na);
+        if (!is_sqr) unpack_narrow(ub, cb, b, nb);
+    }
+
+    NTTArena& arena = NTTArena::instance();
+    u32* f0 = arena.alloc<u32>(N);
+    u32* f1 = arena.alloc<u32>(N);
+    u32* f2 = arena.alloc<u32>(N);
+    auto* rf0 = NTTArena::raw(f0);
+    auto* rf1 = NTTArena::raw(f1);
+    auto* rf2 = NTTArena::raw(f2);
+
+    conv_three_primes<B>(rf0, rf1, rf2, ua, ca, ub, cb, N, live_vecs<B>(len));
+    if (!is_sqr) aligned_free_array(ub);
+    aligned_free_array(ua);
+
+    {
+        ProfileScope ps(PROF_API_CRT);
+        crt_and_propagate_bits(out, out_len, rf0, rf1, rf2, len, NARROW_BITS);
+    }
+
+    arena.dealloc(f2, N);
+    arena.dealloc(f1, N);
+    arena.dealloc(f0, N);
+}
+
+// out[0..out_len) = a * b through 31-bit pieces, for products whose
+// narrow_len(na) + narrow_len(nb) is at most P30X3_MAX_NTT_ANY.
+inline void big_multiply_narrow(
+    u64* out, idt out_len,
+    const u64* a, idt na,
+    const u64* b, idt nb)
+{
+#ifdef NTT_HAS_AVX512
+    if (cpu_has_avx512f()) {
+        big_multiply_narrow_with<Avx512>(out, out_len, a, na, b, nb);
+        return;
+    }
+#endif
+    big_multiply_narrow_with<Avx2>(out, out_len, a, na, b, nb);
+}
 
 // Big integer multiplication (u64 limbs, base 2^64).
 // Input: a[0..na), b[0..nb) are arrays of u64 limbs (little-endian).
 // Output: out[0..out_len) is the product (at least na+nb limbs needed).
-// Dispatches to p30x3 (faster, 3-prime u32) when NTT size fits, else p50x4.
+// Runs on p30x3 (3-prime u32) with u32 limbs while the CRT bound allows,
+// else with 31-bit pieces (big_multiply_narrow) or on p50x4, whichever the
+// cost model rates cheaper.
 inline void big_multiply_u64(
     u64* out, idt out_len,
     const u64* a, idt na,
@@ -174,16 +586,870 @@ inline void big_multiply_u64(
 {
     // u64 little-endian in memory is already a u32 stream — just cast.
     idt na32 = 2 * na, nb32 = 2 * nb, out32 = 2 * out_len;
-    idt ntt_size = ceil_smooth(na32 + nb32 > 64 ? na32 + nb32 : 64);
+    idt n32 = na32 + nb32;
+
+    if (n32 <= P30X3_MAX_NTT_ANY) {
+        const idt ntt_size = ceil_smooth(n32 > 64 ? n32 : 64);
+        if (ntt_size <= P30X3_MAX_NTT || (std::min)(na32, nb32) <= P30X3_CRT_LIMIT) {
+            big_multiply((u32*)out, out32, (const u32*)a, na32, (const u32*)b, nb32);
+            return;
+        }
+    }
+
+    p50x4::Ntt4& engine = p50x4::Ntt4::instance();
+    const idt nw = narrow_len(na) + narrow_len(nb);
+    if (!low_memory() && nw <= P30X3_MAX_NTT_ANY &&
+        ntt_cost(ceil_smooth(nw)) < P50X4_COST * ntt_cost(engine.transform_size(na, nb))) {
+        big_multiply_narrow(out, out_len, a, na, b, nb);
+        return;
+    }
+    engine.multiply(out, static_cast<std::size_t>(out_len),
+                    a, static_cast<std::size_t>(na),
+                    b, static_cast<std::size_t>(nb));
+}
+
+// ── Short products (u64 limbs) ──
+//
+// A short product cannot shrink the convolution itself: the low k
+// coefficients of a * b take as many pointwise products as all of them
+// (multiplication mod x^k has bilinear rank 2k - 1), so the cyclic length
+// stays close to na + nb.  What it can drop is the padding up to the next
+// transform size.  When that is cheaper the convolution runs cyclically at
+// a length L below na + nb, and the e = na + nb - 1 - L coefficients that
+// wrap around are computed by a second convolution of e-limb slices and
+// subtracted from the residues before the CRT: the lowest e for the high
+// product, whose top they land on, and the highest e for the low product.
+
+// x - y for lazy residues in [0, 2*Mod), again in [0, 2*Mod)
+template<u32 Mod>
+NTT_FORCEINLINE u32 sub_lazy(u32 x, u32 y) {
+    const u32 d = x + 2 * Mod - y;
+    return (d >= 2 * Mod) ? d - 2 * Mod : d;
+}
+
+// Cyclic length for a short product of a[0..na) and b[0..nb) (u32 limbs)
+// whose wanted coefficients need at least lmin positions: the length below
+// na + nb that, with its correction convolution, ntt_cost rates cheapest,
+// or 0 when the plain product (product_size_for) is cheaper still.
+template<typename B>
+inline idt short_product_length(idt na, idt nb, idt lmin) {
+    const idt N = product_size_for<B>(na + nb, conv_transform_threads);
+    double best = product_cost<B>(na + nb, N, conv_transform_threads(N));
+    idt best_L = 0;
+    for (idt L = ntt_size_for<B>((std::max)({lmin, na, nb})); L < na + nb;
+         L = ntt_size_for<B>(L + 1)) {
+        const idt e = na + nb - 1 - L;
+        const double c = ntt_cost(L) + (e > 0 ? ntt_cost(ntt_size_for<B>(2 * e)) : 0.0);
+        if (c < best) {
+            best = c;
+            best_L = L;
+        }
+    }
+    return best_L;
+}
+
+// Residues of the convolution of a[0..na) and b[0..nb) (u32 limbs) at a
+// cyclic length max(na, nb) <= L < na + nb, into rf0, rf1, rf2 (L elements
+// each, the first out_vecs Vecs computed).  With keep_high, position r < e
+// then holds coefficient L + r, else coefficient r; from e up, position r
+// holds coefficient r either way.
+template<typename B>
+inline void short_product_conv(
+    u32* rf0, u32* rf1, u32* rf2,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt L, idt out_vecs, bool keep_high)
+{
+    conv_three_primes<B>(rf0, rf1, rf2, a, na, b, nb, L, out_vecs);
+    const idt e = na + nb - 1 - L;
+    if (e <= 0) return;
+
+    // The wrapped coefficients to take out again: 0..e-1 from the low e
+    // limbs of each operand, or L..L+e-1, the top e coefficients of the
+    // product of the top e limbs.  a == b stays a square.
+    const u32* ca = keep_high ? a : a + (na - e);
+    const u32* cb = keep_high ? b : b + (nb - e);
+    const idt off = keep_high ? 0 : e - 1;
+    const idt Nc = ntt_size_for<B>(2 * e);
+
+    NTTArena& arena = NTTArena::instance();
+    u32* c0 = arena.alloc<u32>(Nc);
+    u32* c1 = arena.alloc<u32>(Nc);
+    u32* c2 = arena.alloc<u32>(Nc);
+    auto* rc0 = NTTArena::raw(c0);
+    auto* rc1 = NTTArena::raw(c1);
+    auto* rc2 = NTTArena::raw(c2);
+
+    conv_three_primes<B>(rc0, rc1, rc2, ca, e, cb, e, Nc, live_vecs<B>(off + e));
+    for (idt r = 0; r < e; ++r) {
+        rf0[r] = sub_lazy<CRT_P0>(rf0[r], rc0[off + r]);
+        rf1[r] = sub_lazy<CRT_P1>(rf1[r], rc1[off + r]);
+        rf2[r] = sub_lazy<CRT_P2>(rf2[r], rc2[off + r]);
+    }
+
+    arena.dealloc(c2, Nc);
+    arena.dealloc(c1, Nc);
+    arena.dealloc(c0, Nc);
+}
+
+// out[0..len) = the low len limbs of a * b (u32 limbs), through
+// short_product_conv.  Returns false, leaving out alone, when
+// short_product_length finds padding cheaper.
+template<typename B>
+inline bool mullo_wrapped(
+    u32* out, idt len,
+    const u32* a, idt na,
+    const u32* b, idt nb)
+{
+    const idt L = short_product_length<B>(na, nb, len);
+    if (!L) return false;
+    ProfileScope ps_total(PROF_API_TOTAL);
+
+    NTTArena& arena = NTTArena::instance();
+    u32* f0 = arena.alloc<u32>(L);
+    u32* f1 = arena.alloc<u32>(L);
+    u32* f2 = arena.alloc<u32>(L);
+    auto* rf0 = NTTArena::raw(f0);
+    auto* rf1 = NTTArena::raw(f1);
+    auto* rf2 = NTTArena::raw(f2);
 
-    if (ntt_size <= P30X3_MAX_NTT) {
-        big_multiply((u32*)out, out32, (const u32*)a, na32, (const u32*)b, nb32);
+    short_product_conv<B>(rf0, rf1, rf2, a, na, b, nb, L, live_vecs<B>(len), false);
+    {
+        ProfileScope ps(PROF_API_CRT);
+        crt_and_propagate(out, len, rf0, rf1, rf2);
+    }
+
+    arena.dealloc(f2, L);
+    arena.dealloc(f1, L);
+    arena.dealloc(f0, L);
+    return true;
+}
+
+// out[0..na + nb - skip) = limbs skip.. of a * b (u32 limbs) without the
+// carry out of the limbs below skip, as big_multiply with skip gives them,
+// through short_product_conv.  Returns false, leaving out alone, when
+// short_product_length finds padding cheaper.
+template<typename B>
+inline bool mulhi_wrapped(
+    u32* out,
+    const u32* a, idt na,
+    const u32* b, idt nb, idt skip)
+{
+    // Coefficients below skip may wrap onto the front, nothing above it
+    const idt L = short_product_length<B>(na, nb, na + nb - 1 - skip);
+    if (!L) return false;
+    ProfileScope ps_total(PROF_API_TOTAL);
+
+    const idt len = na + nb - skip;
+    const idt e = na + nb - 1 - L;
+    const idt mid = L - skip;
+
+    NTTArena& arena = NTTArena::instance();
+    u32* f0 = arena.alloc<u32>(L);
+    u32* f1 = arena.alloc<u32>(L);
+    u32* f2 = arena.alloc<u32>(L);
+    auto* rf0 = NTTArena::raw(f0);
+    auto* rf1 = NTTArena::raw(f1);
+    auto* rf2 = NTTArena::raw(f2);
+
+    short_product_conv<B>(rf0, rf1, rf2, a, na, b, nb, L, L / B::LANES, true);
+    {
+        // Coefficients skip..L-1 are in place, L..na+nb-2 at the front
+        ProfileScope ps(PROF_API_CRT);
+        u64 carry = crt_and_propagate(out, mid, rf0 + skip, rf1 + skip, rf2 + skip);
+        const u64 top = (e > 0) ? crt_and_propagate(out + mid, e, rf0, rf1, rf2) : 0;
+        out[len - 1] = u32(top);
+        for (idt i = mid; i < len && carry; ++i) {
+            const u64 s = out[i] + carry;
+            out[i] = u32(s);
+            carry = s >> 32;
+        }
+    }
+
+    arena.dealloc(f2, L);
+    arena.dealloc(f1, L);
+    arena.dealloc(f0, L);
+    return true;
+}
+
+// Low product: out[0..n) = a * b mod 2^(64n), exact.
+// Operand limbs at or above n cannot reach the result and are dropped; the
+// inverse transforms and the CRT stop after n limbs, and in the p30x3 range
+// the transform is cut to mullo_wrapped's length when that is cheaper.
+inline void big_mullo_u64(
+    u64* out, idt n,
+    const u64* a, idt na,
+    const u64* b, idt nb)
+{
+    if (na > n) na = n;
+    if (nb > n) nb = n;
+    if (na == 0 || nb == 0) {
+        std::memset(out, 0, n * sizeof(u64));
+        return;
+    }
+    const idt len = (std::min)(n, na + nb);
+    const idt n32 = 2 * (na + nb);
+    bool done = false;
+    if (!low_memory() && ceil_smooth(n32 > 64 ? n32 : 64) <= P30X3_MAX_NTT) {
+#ifdef NTT_HAS_AVX512
+        if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f())
+            done = mullo_wrapped<Avx512>((u32*)out, 2 * len, (const u32*)a, 2 * na,
+                                         (const u32*)b, 2 * nb);
+        else
+#endif
+        done = mullo_wrapped<Avx2>((u32*)out, 2 * len, (const u32*)a, 2 * na,
+                                   (const u32*)b, 2 * nb);
+    }
+    if (!done) big_multiply_u64(out, len, a, na, b, nb);
+    if (len < n) std::memset(out + len, 0, (n - len) * sizeof(u64));
+}
+
+// High product: out[0..n) approximates the top n limbs of the (na + nb)-limb
+// product, H = floor(a * b / 2^(64 (na + nb - n))), with H - 1 <= out <= H.
+// Operand limbs that only meet partners more than MULHI_GUARD limbs below the
+// result are dropped, and the CRT starts MULHI_GUARD limbs below it without
+// the carry from further down; each omission is far below one unit of out[0].
+// In the p30x3 range the transform is cut to mulhi_wrapped's length when
+// that is cheaper.
+static constexpr idt MULHI_GUARD = 2;
+
+inline void big_mulhi_u64(
+    u64* out, idt n,
+    const u64* a, idt na,
+    const u64* b, idt nb)
+{
+    assert(n <= na + nb);
+    if (na == 0 || nb == 0) {
+        std::memset(out, 0, n * sizeof(u64));
+        return;
+    }
+    // Pairs a[i] * b[j] with i + j < cut are omitted
+    const idt lo = na + nb - n;
+    const idt cut = (lo > MULHI_GUARD + 1) ? lo - MULHI_GUARD - 1 : 0;
+    const idt ta = (cut > nb) ? cut - nb + 1 : 0;
+    const idt tb = (cut > na) ? cut - na + 1 : 0;
+    const u64* a2 = a + ta;
+    const u64* b2 = b + tb;
+    const idt na2 = na - ta, nb2 = nb - tb;
+
+    // Limbs of the truncated product from `start`, MULHI_GUARD below the result
+    const idt rlo = lo - ta - tb;
+    const idt start = (rlo > MULHI_GUARD) ? rlo - MULHI_GUARD : 0;
+    const idt tn = na2 + nb2 - start;
+    u64* t = aligned_alloc_array<u64, 64>(tn);
+
+    idt n32 = 2 * (na2 + nb2);
+    if (ceil_smooth(n32 > 64 ? n32 : 64) <= P30X3_MAX_NTT) {
+        const u32* a32 = (const u32*)a2;
+        const u32* b32 = (const u32*)b2;
+        bool done = false;
+        if (!low_memory()) {
+#ifdef NTT_HAS_AVX512
+            if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f())
+                done = mulhi_wrapped<Avx512>((u32*)t, a32, 2 * na2, b32, 2 * nb2, 2 * start);
+            else
+#endif
+            done = mulhi_wrapped<Avx2>((u32*)t, a32, 2 * na2, b32, 2 * nb2, 2 * start);
+        }
+        if (!done) big_multiply((u32*)t, 2 * tn, a32, 2 * na2, b32, 2 * nb2, 2 * start);
+        std::memcpy(out, t + (rlo - start), n * sizeof(u64));
+        aligned_free_array(t);
     } else {
-        p50x4::Ntt4& engine = p50x4::Ntt4::instance();
-        engine.multiply(out, static_cast<std::size_t>(out_len),
-                        a, static_cast<std::size_t>(na),
-                        b, static_cast<std::size_t>(nb));
+        aligned_free_array(t);
+        u64* full = aligned_alloc_array<u64, 64>(na2 + nb2);
+        big_multiply_u64(full, na2 + nb2, a2, na2, b2, nb2);
+        std::memcpy(out, full + rlo, n * sizeof(u64));
+        aligned_free_array(full);
+    }
+}
+
+// ── Wraparound products (u64 limbs) ──
+//
+// a * b mod (2^(64n) - 1) is the cyclic convolution of length 2n over u32
+// limbs with the carry out of the top folded back into the bottom.  When 2n
+// is itself a transform size this takes one transform of about the size of
+// the result instead of one of the full na + nb limbs, which is what makes
+// the wraparound trick in Newton iterations pay (see bi::mpn_mulmod_bnm1).
+
+// n32 itself if it is a transform size (u32 elements) of the backend
+// big_multiply would pick for it, else 0.
+inline idt cyclic_ntt_size(idt n32) {
+#ifdef NTT_HAS_AVX512
+    if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f())
+        return ntt_size_for<Avx512>(n32) == n32 ? n32 : 0;
+#endif
+    return ntt_size_for<Avx2>(n32) == n32 ? n32 : 0;
+}
+
+// Smallest n' >= n for which big_mulmod_bnm1_u64 runs as a single cyclic
+// transform.  Past the p30x3 range there is none and n is returned as is.
+inline idt mulmod_bnm1_size(idt n) {
+    if (2 * n > P30X3_MAX_CYCLIC_NTT) return n;
+    idt n32 = 2 * n;
+    for (;;) {
+        n32 = ntt_size_for<Avx2>(n32);
+        if (n32 > P30X3_MAX_CYCLIC_NTT) return n;
+        if (cyclic_ntt_size(n32)) return n32 / 2;
+        n32 += Avx2::LANES;
+    }
+}
+
+// out[0..n) = a * b mod (2^(64n) - 1) for na, nb <= n.  A zero residue may
+// come out as 2^(64n) - 1 (all ones).  Sizes other than mulmod_bnm1_size
+// values fall back to the full product, folded.  out must not overlap a or b.
+inline void big_mulmod_bnm1_u64(
+    u64* out, idt n,
+    const u64* a, idt na,
+    const u64* b, idt nb)
+{
+    assert(na <= n && nb <= n);
+    if (na == 0 || nb == 0) {
+        std::memset(out, 0, n * sizeof(u64));
+        return;
+    }
+
+    if (na + nb <= n) {
+        // Nothing wraps: an ordinary product
+        big_multiply_u64(out, na + nb, a, na, b, nb);
+        std::memset(out + na + nb, 0, (n - na - nb) * sizeof(u64));
+        return;
+    }
+
+    u64 carry = 0;
+    const idt N = (2 * n <= P30X3_MAX_CYCLIC_NTT) ? cyclic_ntt_size(2 * n) : 0;
+    if (N) {
+        ProfileScope ps_total(PROF_API_TOTAL);
+#ifdef NTT_HAS_AVX512
+        if (N >= AVX512_MIN_NTT && cpu_has_avx512f())
+            carry = multiply_at_size<Avx512>((u32*)out, N, (const u32*)a, 2 * na,
+                                             (const u32*)b, 2 * nb, N, 0);
+        else
+#endif
+        carry = multiply_at_size<Avx2>((u32*)out, N, (const u32*)a, 2 * na,
+                                       (const u32*)b, 2 * nb, N, 0);
+    } else {
+        u64* full = aligned_alloc_array<u64, 64>(na + nb);
+        big_multiply_u64(full, na + nb, a, na, b, nb);
+        std::memcpy(out, full, n * sizeof(u64));
+        // 2^(64n) == 1: add each further n-limb chunk back in
+        for (idt base = n; base < na + nb; base += n) {
+            const idt len = (std::min)(n, na + nb - base);
+            u64 c = 0;
+            for (idt i = 0; i < n && (i < len || c); ++i) {
+                const u64 x = (i < len) ? full[base + i] : 0;
+                u64 s = out[i] + x;
+                u64 c1 = (s < x);
+                s += c;
+                c1 += (s < c);
+                out[i] = s;
+                c = c1;
+            }
+            carry += c;
+        }
+        aligned_free_array(full);
+    }
+
+    // End-around carry: carry * 2^(64n) == carry.  After the first pass the
+    // value is below 2 * 2^(64n), so a second pass adds at most one.
+    while (carry) {
+        for (idt i = 0; i < n && carry; ++i) {
+            out[i] += carry;
+            carry = (out[i] < carry);
+        }
+    }
+}
+
+// Convolution of b with a cached spectrum fa for one prime.  r holds b[0..nb)
+// reduced by reduce_and_pad3; the first out_vecs Vecs of the result land in r.
+template<typename B, u32 Mod>
+inline void ntt_conv_prepared(
+    u32* r, const u32* fa, idt ntt_vecs,
+    idt nb, idt out_vecs, unsigned threads = 1)
+{
+    using Vec = typename B::Vec;
+    using S = NTTScheduler<B, Mod>;
+    const idt lb = live_vecs<B>(nb);
+    {
+        ProfileScope ps(PROF_API_FORWARD);
+        S::forward((Vec*)r, ntt_vecs, threads, lb);
+    }
+    {
+        ProfileScope ps(PROF_API_FREQMUL);
+        S::freq_multiply((Vec*)r, (const Vec*)fa, ntt_vecs, threads);
+    }
+    {
+        ProfileScope ps(PROF_API_INVERSE);
+        S::inverse((Vec*)r, ntt_vecs, threads, out_vecs, true);
+    }
+}
+
+// ── Prepared operands ──
+//
+// PreparedOperand caches the forward transforms of a fixed operand A so that
+// products A * b for many different b (fixed multipliers, modular
+// exponentiation with a fixed base, repeated use of one divisor inverse) skip
+// A's reduction and forward NTTs.  The transform length is fixed when A is
+// prepared, from max_nb, the largest right operand it will be used with.
+// multiply() only reads the cached spectra, so one PreparedOperand may be
+// shared by concurrent callers.  The p30x3 spectra are laid out for the
+// backend big_multiply would pick for the same product length.
+class PreparedOperand {
+public:
+    PreparedOperand() = default;
+    PreparedOperand(const u64* a, idt na, idt max_nb) { prepare(a, na, max_nb); }
+    ~PreparedOperand() { release(); }
+
+    PreparedOperand(const PreparedOperand&) = delete;
+    PreparedOperand& operator=(const PreparedOperand&) = delete;
+    PreparedOperand(PreparedOperand&& o) noexcept { *this = std::move(o); }
+    PreparedOperand& operator=(PreparedOperand&& o) noexcept {
+        if (this != &o) {
+            release();
+            std::memcpy((void*)this, (const void*)&o, sizeof(*this));
+            std::memset((void*)&o, 0, sizeof(o));
+        }
+        return *this;
+    }
+
+    // (Re)compute the cached transforms for a[0..na), usable with right
+    // operands of up to max_nb limbs.
+    void prepare(const u64* a, idt na, idt max_nb) {
+        release();
+        na_ = na;
+        max_nb_ = max_nb;
+        if (na == 0 || max_nb == 0) return;
+
+        const idt n32 = 2 * (na + max_nb);
+        if (n32 <= P30X3_MAX_NTT) {
+#ifdef NTT_HAS_AVX512
+            if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f()) {
+                avx512_ = true;
+                prepare_with<Avx512>(a, na, n32);
+                return;
+            }
+#endif
+            prepare_with<Avx2>(a, na, n32);
+        } else {
+            N_ = p50x4::Ntt4::transform_size(na, max_nb);
+            for (int i = 0; i < 4; ++i) d_[i] = p50x4::alloc_doubles(N_);
+            p50x4::Ntt4::instance().prepare(d_, N_, a, na);
+        }
+    }
+
+    idt size() const { return na_; }
+    idt max_other() const { return max_nb_; }
+    bool empty() const { return N_ == 0; }
+
+private:
+    friend void multiply(u64*, idt, const PreparedOperand&, const u64*, idt);
+
+    template<typename B>
+    void prepare_with(const u64* a, idt na, idt n32) {
+        const idt N = ntt_size_for<B>(n32);
+        const idt ntt_vecs = N / B::LANES;
+        N_ = N;
+        for (int i = 0; i < 3; ++i) f_[i] = aligned_alloc_array<u32, 64>(N);
+        const idt la = live_vecs<B>(2 * na);
+        reduce_and_pad3<B>(f_[0], f_[1], f_[2], (const u32*)a, 2 * na, la * B::LANES);
+        NTTScheduler<B, CRT_P0>::forward((typename B::Vec*)f_[0], ntt_vecs, 1, la);
+        NTTScheduler<B, CRT_P1>::forward((typename B::Vec*)f_[1], ntt_vecs, 1, la);
+        NTTScheduler<B, CRT_P2>::forward((typename B::Vec*)f_[2], ntt_vecs, 1, la);
+    }
+
+    template<typename B>
+    void multiply_with(u64* out, idt out_len, const u64* b, idt nb) const;
+
+    void release() {
+        for (auto& p : f_) { if (p) aligned_free_array(p); p = nullptr; }
+        for (auto& p : d_) { if (p) p50x4::free_doubles(p); p = nullptr; }
+        N_ = 0;
+        avx512_ = false;
+    }
+
+    idt na_ = 0, max_nb_ = 0;
+    idt N_ = 0;                  // u32 elements (p30x3) or 80-bit coefficients (p50x4)
+    bool avx512_ = false;        // p30x3 spectra in the Avx512 layout
+    u32* f_[3] = {};             // p30x3 spectra, one per prime
+    double* d_[4] = {};          // p50x4 spectra, one per prime
+};
+
+// out[0..out_len) = A * b[0..nb) for a prepared A.  Throws std::length_error
+// if nb > a.max_other(): the cached transforms are too short for b.
+inline void multiply(u64* out, idt out_len,
+                     const PreparedOperand& a, const u64* b, idt nb) {
+    if (nb > a.max_nb_)
+        throw std::length_error("ntt::multiply: right operand longer than max_other()");
+    if (a.empty() || nb == 0) {
+        std::memset(out, 0, out_len * sizeof(u64));
+        return;
+    }
+    if (a.d_[0]) {
+        p50x4::Ntt4::instance().multiply_prepared(
+            out, out_len, a.d_, a.na_, a.N_, b, nb);
+        return;
+    }
+
+    ProfileScope ps_total(PROF_API_TOTAL);
+#ifdef NTT_HAS_AVX512
+    if (a.avx512_) {
+        a.multiply_with<Avx512>(out, out_len, b, nb);
+        return;
+    }
+#endif
+    a.multiply_with<Avx2>(out, out_len, b, nb);
+}
+
+template<typename B>
+void PreparedOperand::multiply_with(u64* out, idt out_len, const u64* b, idt nb) const {
+    using Vec = typename B::Vec;
+    const idt N = N_;
+    const idt ntt_vecs = N / B::LANES;
+    const idt nb32 = 2 * nb;
+    const idt out32 = 2 * out_len;
+    const idt result_len = (std::min)(2 * na_ + nb32, out32);
+    const idt out_vecs = live_vecs<B>(result_len);
+    const unsigned threads = num_threads();
+    const bool parallel = threads > 1 && N >= PARALLEL_PRIMES_MIN_NTT;
+
+    NTTArena& arena = NTTArena::instance();
+    Vec* r[3];
+    for (auto& p : r) p = arena.alloc<Vec>(ntt_vecs);
+    {
+        ProfileScope ps(PROF_API_REDUCE_PAD);
+        reduce_and_pad3<B>((u32*)NTTArena::raw(r[0]), (u32*)NTTArena::raw(r[1]),
+                           (u32*)NTTArena::raw(r[2]), (const u32*)b, nb32,
+                           live_vecs<B>(nb32) * B::LANES);
+    }
+
+    auto one_prime = [&](idt p, unsigned t) {
+        u32* rp = (u32*)NTTArena::raw(r[p]);
+        if (p == 0)
+            ntt_conv_prepared<B, CRT_P0>(rp, f_[0], ntt_vecs, nb32, out_vecs, t);
+        else if (p == 1)
+            ntt_conv_prepared<B, CRT_P1>(rp, f_[1], ntt_vecs, nb32, out_vecs, t);
+        else
+            ntt_conv_prepared<B, CRT_P2>(rp, f_[2], ntt_vecs, nb32, out_vecs, t);
+    };
+
+    if (parallel) {
+        const unsigned per_prime = (threads + 2) / 3;
+        ThreadPool::instance().parallel_for(3, threads, [&](idt p) { one_prime(p, per_prime); });
+    } else {
+        for (idt p = 0; p < 3; ++p) one_prime(p, 1);
+    }
+
+    {
+        ProfileScope ps(PROF_API_CRT);
+        crt_and_propagate((u32*)out, result_len,
+                          (u32*)NTTArena::raw(r[0]), (u32*)NTTArena::raw(r[1]),
+                          (u32*)NTTArena::raw(r[2]));
+    }
+    if (result_len < out32)
+        std::memset((u32*)out + result_len, 0, (out32 - result_len) * sizeof(u32));
+
+    for (int p = 2; p >= 0; --p) arena.dealloc(r[p], ntt_vecs);
+}
+
+// ── Batched products ──
+//
+// big_multiply_batch runs many independent u64 products.  Each product in
+// the p30x3 range runs whole on one thread, its three primes one after
+// another, and the products are spread over num_threads() threads, largest
+// transform first.  For products of a few thousand limbs this scales better
+// than splitting each small transform across the pool, as big_multiply_u64
+// does.  On one thread it costs the same as a loop of big_multiply_u64
+// calls: taking the products of a transform length prime by prime, to share
+// root tables, measured no faster.  Products past the p30x3 range, and all
+// of them in low-memory mode, go through big_multiply_u64 one at a time.
+
+struct MulJob {
+    u64* out;           // out[0..out_len), as for big_multiply_u64
+    idt out_len;
+    const u64* a;
+    idt na;
+    const u64* b;
+    idt nb;
+};
+
+// One job of big_multiply_batch at transform length N on backend B, on the
+// calling thread only.
+template<typename B>
+inline void batch_one(const MulJob& m, idt N) {
+    const idt ntt_vecs = N / B::LANES;
+    const bool is_sqr = (m.a == m.b && m.na == m.nb);
+    const idt na32 = 2 * m.na, nb32 = 2 * m.nb;
+    const idt result_len = (std::min)(na32 + nb32, 2 * m.out_len);
+    const idt out_vecs = live_vecs<B>(result_len);
+    const u32* b = is_sqr ? nullptr : (const u32*)m.b;
+
+    NTTArena& arena = NTTArena::instance();
+    u32* buf[4];
+    u32* r[4];   // f0..2, g
+    for (int k = 0; k < 4; ++k) {
+        buf[k] = arena.alloc<u32>(N);
+        r[k] = NTTArena::raw(buf[k]);
+    }
+    reduce_and_pad3<B>(r[0], r[1], r[2], (const u32*)m.a, na32, live_vecs<B>(na32) * B::LANES);
+    ntt_conv_one_prime<B, CRT_P0>(r[0], r[3], ntt_vecs, na32, b, nb32, out_vecs, false);
+    ntt_conv_one_prime<B, CRT_P1>(r[1], r[3], ntt_vecs, na32, b, nb32, out_vecs, false);
+    ntt_conv_one_prime<B, CRT_P2>(r[2], r[3], ntt_vecs, na32, b, nb32, out_vecs, false);
+    crt_and_propagate((u32*)m.out, result_len, r[0], r[1], r[2]);
+    for (int k = 3; k >= 0; --k) arena.dealloc(buf[k], N);
+}
+
+// Run jobs[0..count).  Each job is out[0..out_len) = a * b as with
+// big_multiply_u64; no job's output may overlap another job's operands.
+inline void big_multiply_batch(const MulJob* jobs, idt count) {
+    struct Entry {
+        idt N;
+        bool wide;          // AVX-512 backend
+        const MulJob* job;
+    };
+    // batch_one runs each job on a single thread
+    const auto one_thread = [](idt) { return 1u; };
+    std::vector<Entry> batch;
+    batch.reserve(count);
+    for (idt i = 0; i < count; ++i) {
+        const MulJob& m = jobs[i];
+        if (m.na == 0 || m.nb == 0) {
+            std::memset(m.out, 0, m.out_len * sizeof(u64));
+            continue;
+        }
+        const idt n32 = 2 * (m.na + m.nb);
+        if (low_memory() || n32 > P30X3_MAX_NTT) {
+            big_multiply_u64(m.out, m.out_len, m.a, m.na, m.b, m.nb);
+            continue;
+        }
+#ifdef NTT_HAS_AVX512
+        if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f()) {
+            batch.push_back({product_size_for<Avx512>(n32, one_thread), true, &m});
+            continue;
+        }
+#endif
+        batch.push_back({product_size_for<Avx2>(n32, one_thread), false, &m});
+    }
+    // Largest first, so the last products handed out are the short ones
+    std::stable_sort(batch.begin(), batch.end(), [](const Entry& x, const Entry& y) {
+        return x.N > y.N;
+    });
+
+    ThreadPool::instance().parallel_for(batch.size(), num_threads(), [&](idt i) {
+        const Entry& e = batch[i];
+#ifdef NTT_HAS_AVX512
+        if (e.wide) {
+            batch_one<Avx512>(*e.job, e.N);
+            return;
+        }
+#endif
+        batch_one<Avx2>(*e.job, e.N);
+    });
+}
+
+// ── Sums of products ──
+//
+// big_dot computes sum_i a_i * b_i.  The transforms are linear, so the
+// pointwise products of all terms are summed in the frequency domain and a
+// group of terms costs one inverse transform and one CRT per prime in
+// total.  A group is limited by the CRT bound: each coefficient of the sum
+// is below sum_i min(na_i, nb_i) * (2^32 - 1)^2 (u32 limbs), which must stay
+// below P0*P1*P2, so terms are split into groups whose min(na_i, nb_i) add
+// up to at most DOT_CRT_BUDGET u32 limbs, and the groups' sums are added as
+// integers.  Terms are first bucketed by the transform big_multiply would
+// use for them alone, and groups never mix buckets, so a large term does not
+// make the small ones pay for its transform length.
+
+struct DotTerm {
+    const u64* a;
+    idt na;
+    const u64* b;
+    idt nb;
+};
+
+static constexpr idt DOT_CRT_BUDGET = P30X3_CRT_LIMIT;
+
+// Add one term's pointwise product into the spectrum acc for one prime.  f
+// holds a reduced; b == nullptr squares a.
+template<typename B, u32 Mod>
+inline void dot_term_one_prime(
+    u32* acc, u32* f, u32* g, idt na32,
+    const u32* b, idt nb32, idt ntt_vecs, bool first, unsigned threads)
+{
+    using Vec = typename B::Vec;
+    using S = NTTScheduler<B, Mod>;
+
+    const idt la = live_vecs<B>(na32), lb = live_vecs<B>(nb32);
+    S::forward((Vec*)f, ntt_vecs, threads, la);
+    if (b) {
+        reduce_and_pad<B, Mod>(g, b, nb32, lb * B::LANES);
+        S::forward((Vec*)g, ntt_vecs, threads, lb);
+    } else {
+        std::memcpy(g, f, ntt_vecs * sizeof(Vec));
+    }
+    S::freq_multiply((Vec*)f, (const Vec*)g, ntt_vecs, threads);
+
+    const idt n = ntt_vecs * B::LANES;
+    if (first) {
+        std::memcpy(acc, f, n * sizeof(u32));
+        return;
+    }
+    // [0, 2M) + [0, 2M), back to [0, 2M)
+    constexpr u32 Mod2 = 2 * Mod;
+    for (idt i = 0; i < n; ++i) {
+        const u32 x = acc[i] + f[i];
+        acc[i] = (x >= Mod2) ? x - Mod2 : x;
+    }
+}
+
+// One group of big_dot at transform length N: the low len32 u32 limbs of
+// the sum go to dst; returns the carry out of them.
+template<typename B>
+inline u64 dot_group(u32* dst, idt len32, const DotTerm* const* terms, idt count, idt N) {
+    const idt ntt_vecs = N / B::LANES;
+    const idt out_vecs = live_vecs<B>(len32);
+    const unsigned threads = N >= PARALLEL_PRIMES_MIN_NTT ? num_threads() : 1;
+
+    NTTArena& arena = NTTArena::instance();
+    u32* buf[7];
+    u32* r[7];   // acc0..2, f0..2, g
+    for (int k = 0; k < 7; ++k) {
+        buf[k] = arena.alloc<u32>(N);
+        r[k] = NTTArena::raw(buf[k]);
+    }
+
+    for (idt t = 0; t < count; ++t) {
+        const DotTerm& m = *terms[t];
+        const idt na32 = 2 * m.na, nb32 = 2 * m.nb;
+        const u32* b = (m.a == m.b && m.na == m.nb) ? nullptr : (const u32*)m.b;
+        reduce_and_pad3<B>(r[3], r[4], r[5], (const u32*)m.a, na32,
+                           live_vecs<B>(na32) * B::LANES);
+        dot_term_one_prime<B, CRT_P0>(r[0], r[3], r[6], na32, b, nb32, ntt_vecs, t == 0, threads);
+        dot_term_one_prime<B, CRT_P1>(r[1], r[4], r[6], na32, b, nb32, ntt_vecs, t == 0, threads);
+        dot_term_one_prime<B, CRT_P2>(r[2], r[5], r[6], na32, b, nb32, ntt_vecs, t == 0, threads);
+    }
+
+    NTTScheduler<B, CRT_P0>::inverse((typename B::Vec*)r[0], ntt_vecs, threads, out_vecs, true);
+    NTTScheduler<B, CRT_P1>::inverse((typename B::Vec*)r[1], ntt_vecs, threads, out_vecs, true);
+    NTTScheduler<B, CRT_P2>::inverse((typename B::Vec*)r[2], ntt_vecs, threads, out_vecs, true);
+    const u64 carry = crt_and_propagate(dst, len32, r[0], r[1], r[2]);
+
+    for (int k = 6; k >= 0; --k) arena.dealloc(buf[k], N);
+    return carry;
+}
+
+// out[0..n) += src[0..sn), carries past n dropped
+inline void add_into_u64(u64* out, idt n, const u64* src, idt sn) {
+    u64 c = 0;
+    idt i = 0;
+    for (; i < sn && i < n; ++i) {
+        u64 s = out[i] + src[i];
+        u64 c1 = (s < src[i]);
+        s += c;
+        c1 += (s < c);
+        out[i] = s;
+        c = c1;
+    }
+    for (; c && i < n; ++i) {
+        out[i] += c;
+        c = (out[i] < c);
+    }
+}
+
+// out[0..out_len) = sum of terms[i].a * terms[i].b, mod 2^(64 out_len).
+// out_len = max(na_i + nb_i) + 1 always holds the whole sum.  out must not
+// overlap any operand.
+inline void big_dot(u64* out, idt out_len, const DotTerm* terms, idt count) {
+    std::memset(out, 0, out_len * sizeof(u64));
+    if (out_len == 0) return;
+    u64* tmp = aligned_alloc_array<u64, 64>(out_len + 1);
+    bool first = true;   // out still zero: the first group lands there directly
+
+    // Terms past the p30x3 range: full products, added as integers.  The
+    // rest are bucketed by backend and transform length.
+    struct Entry {
+        idt N;
+        bool wide;          // AVX-512 backend
+        const DotTerm* term;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(count);
+    for (idt i = 0; i < count; ++i) {
+        const DotTerm& m = terms[i];
+        if (m.na == 0 || m.nb == 0) continue;
+        const idt n32 = 2 * (m.na + m.nb);
+        if (n32 > P30X3_MAX_NTT) {
+            const idt len = (std::min)(m.na + m.nb, out_len);
+            big_multiply_u64(tmp, len, m.a, m.na, m.b, m.nb);
+            add_into_u64(out, out_len, tmp, len);
+            first = false;
+            continue;
+        }
+#ifdef NTT_HAS_AVX512
+        if (n32 >= AVX512_MIN_NTT && cpu_has_avx512f()) {
+            entries.push_back({ntt_size_for<Avx512>(n32), true, &m});
+            continue;
+        }
+#endif
+        entries.push_back({ntt_size_for<Avx2>(n32), false, &m});
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& x, const Entry& y) {
+        return x.wide != y.wide ? x.wide < y.wide : x.N < y.N;
+    });
+    std::vector<const DotTerm*> group(entries.size());
+    for (idt i = 0; i < entries.size(); ++i) group[i] = entries[i].term;
+
+    for (idt i = 0; i < entries.size();) {
+        // Largest run of terms of one bucket within the CRT budget
+        const idt N = entries[i].N;
+        const bool wide = entries[i].wide;
+        idt budget = 0, max_len = 0, j = i;
+        for (; j < entries.size() && entries[j].N == N && entries[j].wide == wide; ++j) {
+            const idt w = 2 * (std::min)(group[j]->na, group[j]->nb);
+            if (j > i && budget + w > DOT_CRT_BUDGET) break;
+            budget += w;
+            max_len = (std::max)(max_len, group[j]->na + group[j]->nb);
+        }
+
+        const idt len32 = (std::min)(2 * max_len, 2 * out_len);
+        u64* dst = first ? out : tmp;
+        u64 carry;
+#ifdef NTT_HAS_AVX512
+        if (wide)
+            carry = dot_group<Avx512>((u32*)dst, len32, group.data() + i, j - i, N);
+        else
+#endif
+        carry = dot_group<Avx2>((u32*)dst, len32, group.data() + i, j - i, N);
+        // Sum limbs from len32 / 2 on are just the carry
+        idt sn = len32 / 2;
+        if (sn < out_len) dst[sn++] = carry;
+        if (!first) add_into_u64(out, out_len, tmp, sn);
+        first = false;
+        i = j;
+    }
+    aligned_free_array(tmp);
+}
+
+// ── Warm-up ──
+//
+// The first product of a size pays one-time costs: the root tables of each
+// prime and backend, the calling thread's p50x4 engine (FftCtx tables,
+// w2tab grown to the transform depth, the Bailey workspace), spawning the
+// pool workers, and page faults on fresh scratch buffers.  warmup() pays
+// them up front with one product per size from 64 limbs up to max_limbs,
+// doubling, on `threads` threads (0 = hardware_concurrency), through the
+// same dispatch as big_multiply_u64.  The scratch buffers of each size stay
+// cached in the arena as far as arena_cap() allows, largest last.  Changes
+// num_threads() while it runs, so call it before other threads multiply.
+inline void warmup(idt max_limbs, unsigned threads = 1) {
+    if (max_limbs <= 0) return;
+    const unsigned saved = num_threads();
+    set_num_threads(threads);
+    std::vector<u64> a(max_limbs, ~u64(0)), b(max_limbs, ~u64(0)), out(2 * max_limbs);
+    idt n = max_limbs;
+    while (n > 64) n = (n + 1) / 2;
+    for (;; n = (std::min)(2 * n, max_limbs)) {
+        big_multiply_u64(out.data(), 2 * n, a.data(), n, b.data(), n);
+        if (n == max_limbs) break;
     }
+    num_threads_ref().store(saved, std::memory_order_relaxed);
 }
 
 } // namespace ntt
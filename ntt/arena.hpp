@@ -1,39 +1,119 @@
 #pragma once
 #include "common.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
 #include <vector>
 
 namespace ntt {
 
+// ── Arena cap and statistics ──
+
+// Idle bytes the process-wide depot may hold (NTT_ARENA_CAP_MB, default
+// 1 GiB).  A buffer returned past the cap evicts the least recently used
+// bins.
+inline std::atomic<size_t>& arena_cap_ref() {
+    static std::atomic<size_t> cap{[] {
+        const char* p = std::getenv("NTT_ARENA_CAP_MB");
+        return p ? size_t(std::strtoull(p, nullptr, 10)) << 20 : size_t(1) << 30;
+    }()};
+    return cap;
+}
+
+inline size_t arena_cap() {
+    return arena_cap_ref().load(std::memory_order_relaxed);
+}
+
+// Cumulative hits (served from a cached buffer), misses (fresh allocation)
+// and evictions since start; bytes currently cached (depot and thread
+// caches) and handed out; peak of their sum.
+struct ArenaStats {
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+    u64 bytes_held;
+    u64 bytes_in_use;
+    u64 peak_bytes;
+};
+
+struct ArenaCounters {
+    std::atomic<u64> hits{0}, misses{0}, evictions{0};
+    std::atomic<u64> held{0}, in_use{0}, peak{0};
+
+    // Never destroyed, like the depot.
+    static ArenaCounters& instance() {
+        static ArenaCounters* c = new ArenaCounters;
+        return *c;
+    }
+
+    void note_alloc(u64 bytes) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        const u64 total = in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes +
+                          held.load(std::memory_order_relaxed);
+        u64 p = peak.load(std::memory_order_relaxed);
+        while (total > p && !peak.compare_exchange_weak(p, total, std::memory_order_relaxed)) {}
+    }
+};
+
+inline ArenaStats arena_stats() {
+    const ArenaCounters& c = ArenaCounters::instance();
+    return {c.hits.load(std::memory_order_relaxed), c.misses.load(std::memory_order_relaxed),
+            c.evictions.load(std::memory_order_relaxed), c.held.load(std::memory_order_relaxed),
+            c.in_use.load(std::memory_order_relaxed), c.peak.load(std::memory_order_relaxed)};
+}
+
 // Pool allocator for NTT scratch buffers.
-// Sizes are {1,3,5} * 2^k. Bins are assigned sequential indices
-// in sorted size order so that bin[i+1] > bin[i]:
-//   ..., 2^k, 5*2^(k-2), 3*2^(k-1), 2^(k+1), ...
+// Sizes are {1,3,5,15} * 2^k bytes (element counts of that form times a
+// power-of-two element size), so buffers of different element types share
+// bins. Bins are assigned sequential indices in sorted size order so that
+// bin[i+1] > bin[i]:
+//   ..., 2^k, 5*2^(k-2), 3*2^(k-1), 15*2^(k-3), 2^(k+1), ...
 //
 // Alloc may return a slightly larger recycled buffer (up to ~2x).
 // Two tag bits in bits 62-63 of the pointer record the bin offset,
 // so dealloc can return the buffer to its correct bin.
+//
+// Buffers are cached at two levels.  Each thread keeps a few small buffers
+// per bin (at most CACHE_PER_BIN of up to CACHE_MAX_BYTES each, so a few MB
+// per thread); everything else goes back to the process-wide ArenaDepot,
+// where any thread can reuse it and the byte cap applies.  A thread's cache
+// is handed to the depot when the thread exits.
 struct NTTArena {
-    // Sorted index formula (sequential for count >= 4):
-    //   m=1: 3*k        where count = 2^k
-    //   m=5: 3*(k+2)+1  where count = 5*2^k
-    //   m=3: 3*(k+1)+2  where count = 3*2^k
-    static constexpr int NUM_BINS = 3 * (MAX_LOG + 1);
-
-    std::vector<void*> bins[NUM_BINS];
-
-    ~NTTArena() {
-        for (auto& bin : bins)
-            for (void* p : bin)
-                aligned_free_array<char>(static_cast<char*>(p));
+    // Sorted index formula (sequential for bytes >= 8):
+    //   m=1:  4*k        where bytes = 2^k
+    //   m=5:  4*(k+2)+1  where bytes = 5*2^k
+    //   m=3:  4*(k+1)+2  where bytes = 3*2^k
+    //   m=15: 4*(k+3)+3  where bytes = 15*2^k
+    // Covers buffers below 2^44 bytes.
+    static constexpr int NUM_BINS = 4 * 48;
+
+    static constexpr size_t CACHE_PER_BIN = 4;
+    static constexpr size_t CACHE_MAX_BYTES = size_t(1) << 18;
+
+    struct Block {
+        void* p;
+        size_t bytes;
+    };
+
+    // Map bytes = {1,3,5,15}*2^k to sequential sorted index.
+    static int sorted_index(idt bytes) {
+        int k = ntt_ctzll(static_cast<unsigned long long>(bytes));
+        idt m = bytes >> k;
+        if (m == 1) return 4 * k;
+        if (m == 5) return 4 * (k + 2) + 1;
+        if (m == 15) return 4 * (k + 3) + 3;
+        return 4 * (k + 1) + 2;  // m == 3
     }
 
-    // Map count = {1,3,5}*2^k to sequential sorted index.
-    static int sorted_index(idt count) {
-        int k = ntt_ctzll(static_cast<unsigned long long>(count));
-        idt m = count >> k;
-        if (m == 1) return 3 * k;
-        if (m == 5) return 3 * (k + 2) + 1;
-        return 3 * (k + 1) + 2;  // m == 3
+    // Inverse of sorted_index (for indices that some size maps to).
+    static idt bin_bytes(int idx) {
+        const int k = idx >> 2;
+        switch (idx & 3) {
+        case 0: return idt(1) << k;
+        case 1: return idt(5) << (k - 2);
+        case 2: return idt(3) << (k - 1);
+        default: return idt(15) << (k - 3);
+        }
     }
 
     // Pointer tagging: 2 bits in bits 62-63
@@ -57,29 +137,21 @@ struct NTTArena {
         return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(p) & ADDR_MASK);
     }
 
+    std::vector<Block> bins[NUM_BINS];
+
+    ~NTTArena() { flush(); }
+
     // Allocate count elements of type T.  Returns a TAGGED pointer.
     // Use raw() for the usable address.  Pass the tagged pointer to dealloc().
     template<typename T>
-    T* alloc(idt count) {
-        int idx = sorted_index(count);
-        for (int off = 0; off < 4 && idx + off < NUM_BINS; ++off) {
-            auto& bin = bins[idx + off];
-            if (!bin.empty()) {
-                void* p = bin.back();
-                bin.pop_back();
-                return tag_ptr(static_cast<T*>(p), off);
-            }
-        }
-        return aligned_alloc_array<T, 64>(count);  // tag=0
-    }
+    T* alloc(idt count);
 
     // Return a (possibly tagged) pointer to its correct bin.
     template<typename T>
-    void dealloc(T* p, idt requested_count) {
-        int off = get_tag(p);
-        int actual_idx = sorted_index(requested_count) + off;
-        bins[actual_idx].push_back(raw(p));
-    }
+    void dealloc(T* p, idt requested_count);
+
+    // Hand this thread's cached buffers to the depot.
+    void flush();
 
     static NTTArena& instance() {
         static thread_local NTTArena arena;
@@ -87,4 +159,159 @@ struct NTTArena {
     }
 };
 
+// Process-wide buffer depot, sharded by bin: each bin has its own lock, so
+// threads working on different sizes do not contend.  When the idle bytes
+// exceed arena_cap(), whole bins are evicted, least recently used first.
+// Never destroyed: thread caches flush into it during static destruction.
+class ArenaDepot {
+    static constexpr int NUM_BINS = NTTArena::NUM_BINS;
+    using Block = NTTArena::Block;
+
+    struct Shard {
+        std::mutex mu;
+        std::vector<Block> blocks;
+        std::atomic<u64> last_use{0};
+        std::atomic<size_t> count{0};
+    };
+
+    Shard shards_[NUM_BINS];
+    std::atomic<u64> clock_{0};
+
+public:
+    static ArenaDepot& instance() {
+        static ArenaDepot* depot = new ArenaDepot;
+        return *depot;
+    }
+
+    // Pop a buffer from bin idx; false if the bin is empty.
+    bool take(int idx, Block& out) {
+        Shard& s = shards_[idx];
+        if (s.count.load(std::memory_order_relaxed) == 0) return false;
+        std::lock_guard<std::mutex> lk(s.mu);
+        if (s.blocks.empty()) return false;
+        out = s.blocks.back();
+        s.blocks.pop_back();
+        s.count.store(s.blocks.size(), std::memory_order_relaxed);
+        s.last_use.store(clock_.fetch_add(1, std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+        ArenaCounters::instance().held.fetch_sub(out.bytes, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Counted as held before it becomes visible, so that a concurrent take
+    // never drives the count below zero.
+    void give(int idx, Block b) {
+        ArenaCounters& c = ArenaCounters::instance();
+        const u64 held = c.held.fetch_add(b.bytes, std::memory_order_relaxed) + b.bytes;
+        Shard& s = shards_[idx];
+        {
+            std::lock_guard<std::mutex> lk(s.mu);
+            s.blocks.push_back(b);
+            s.count.store(s.blocks.size(), std::memory_order_relaxed);
+            s.last_use.store(clock_.fetch_add(1, std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        }
+        if (held > arena_cap()) trim(arena_cap());
+    }
+
+    // Free idle buffers, coldest bin first, until at most keep_bytes are held.
+    void trim(size_t keep_bytes) {
+        ArenaCounters& c = ArenaCounters::instance();
+        while (c.held.load(std::memory_order_relaxed) > keep_bytes) {
+            int coldest = -1;
+            u64 oldest = ~u64(0);
+            for (int i = 0; i < NUM_BINS; ++i) {
+                if (shards_[i].count.load(std::memory_order_relaxed) == 0) continue;
+                const u64 t = shards_[i].last_use.load(std::memory_order_relaxed);
+                if (t < oldest) { oldest = t; coldest = i; }
+            }
+            if (coldest < 0) return;  // the rest sits in thread caches
+
+            Block b;
+            {
+                Shard& s = shards_[coldest];
+                std::lock_guard<std::mutex> lk(s.mu);
+                if (s.blocks.empty()) continue;
+                b = s.blocks.back();
+                s.blocks.pop_back();
+                s.count.store(s.blocks.size(), std::memory_order_relaxed);
+            }
+            c.held.fetch_sub(b.bytes, std::memory_order_relaxed);
+            c.evictions.fetch_add(1, std::memory_order_relaxed);
+            aligned_free_bytes(b.p);
+        }
+    }
+};
+
+template<typename T>
+T* NTTArena::alloc(idt count) {
+    static_assert((sizeof(T) & (sizeof(T) - 1)) == 0, "element size must be a power of two");
+    const idt bytes = count * sizeof(T);
+    const int idx = sorted_index(bytes);
+    assert(bin_bytes(idx) == bytes);
+    ArenaCounters& c = ArenaCounters::instance();
+    const bool small = size_t(bytes) <= CACHE_MAX_BYTES;
+    for (int off = 0; off < 4 && idx + off < NUM_BINS; ++off) {
+        Block b;
+        bool found = false;
+        auto& bin = bins[idx + off];
+        if (small && !bin.empty()) {
+            b = bin.back();
+            bin.pop_back();
+            c.held.fetch_sub(b.bytes, std::memory_order_relaxed);
+            found = true;
+        } else {
+            found = ArenaDepot::instance().take(idx + off, b);
+        }
+        if (found) {
+            c.hits.fetch_add(1, std::memory_order_relaxed);
+            c.in_use.fetch_add(b.bytes, std::memory_order_relaxed);
+            return tag_ptr(static_cast<T*>(b.p), off);
+        }
+    }
+    T* p = aligned_alloc_array<T, 64>(count);  // tag=0
+    if (p) c.note_alloc(bytes);
+    return p;
+}
+
+template<typename T>
+void NTTArena::dealloc(T* p, idt requested_count) {
+    const int actual_idx = sorted_index(requested_count * sizeof(T)) + get_tag(p);
+    const Block b{raw(p), size_t(bin_bytes(actual_idx))};
+    ArenaCounters& c = ArenaCounters::instance();
+    c.in_use.fetch_sub(b.bytes, std::memory_order_relaxed);
+    auto& bin = bins[actual_idx];
+    if (b.bytes <= CACHE_MAX_BYTES && bin.size() < CACHE_PER_BIN) {
+        c.held.fetch_add(b.bytes, std::memory_order_relaxed);
+        bin.push_back(b);
+    } else {
+        ArenaDepot::instance().give(actual_idx, b);
+    }
+}
+
+inline void NTTArena::flush() {
+    ArenaCounters& c = ArenaCounters::instance();
+    ArenaDepot& depot = ArenaDepot::instance();
+    for (int i = 0; i < NUM_BINS; ++i) {
+        for (const Block& b : bins[i]) {
+            c.held.fetch_sub(b.bytes, std::memory_order_relaxed);
+            depot.give(i, b);
+        }
+        bins[i].clear();
+    }
+}
+
+// Set the depot's idle-byte cap; evicts at once if it is now exceeded.
+inline void set_arena_cap(size_t bytes) {
+    arena_cap_ref().store(bytes, std::memory_order_relaxed);
+    ArenaDepot::instance().trim(bytes);
+}
+
+// Free the calling thread's cached buffers and the depot's idle buffers.
+// Small buffers cached by other threads stay where they are.
+inline void arena_trim() {
+    NTTArena::instance().flush();
+    ArenaDepot::instance().trim(0);
+}
+
 } // namespace ntt
@@ -4,8 +4,17 @@
 #include <cstddef>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <immintrin.h>
 
+#if defined(_MSC_VER)
+  #include <malloc.h>
+#elif defined(__linux__)
+  #include <sys/mman.h>
+#endif
+
 // ── Force-inline / hot function macros ──
 #if defined(_MSC_VER)
   #define NTT_FORCEINLINE __forceinline
@@ -145,41 +154,153 @@ inline u64 n_revbin(u64 x, int bits) {
     return r;
 }
 
+// ── Low-memory mode ──
+//
+// Trades speed for scratch: the primes of a product run one after another
+// instead of concurrently (see api.hpp and p50x4/multiply.hpp).
+inline std::atomic<bool>& low_memory_ref() {
+    static std::atomic<bool> on{false};
+    return on;
+}
+
+inline bool low_memory() {
+    return low_memory_ref().load(std::memory_order_relaxed);
+}
+
+inline void set_low_memory(bool on) {
+    low_memory_ref().store(on, std::memory_order_relaxed);
+}
+
 // ── Aligned allocation ──
+//
+// Buffers of at least HUGE_PAGE_MIN_BYTES are aligned to 2 MB and, on Linux,
+// advised MADV_HUGEPAGE so transparent huge pages can back them: the strided
+// outer passes, Bailey transposes and CRT sweeps over tens of MB otherwise
+// miss the dTLB on nearly every new row.  It only takes effect where THP is
+// "always" or "madvise" (/sys/kernel/mm/transparent_hugepage/enabled);
+// elsewhere, or if madvise fails, the buffer silently stays on 4 KB pages.
+// NTT_HUGE_PAGES=0 or set_huge_pages(false) turns the path off.
+static constexpr idt HUGE_PAGE_BYTES = idt(1) << 21;
+static constexpr idt HUGE_PAGE_MIN_BYTES = idt(1) << 22;
+
+inline std::atomic<bool>& huge_pages_ref() {
+    static std::atomic<bool> on{[] {
+        const char* p = std::getenv("NTT_HUGE_PAGES");
+        return !(p && p[0] == '0');
+    }()};
+    return on;
+}
+
+inline bool huge_pages() {
+    return huge_pages_ref().load(std::memory_order_relaxed);
+}
+
+inline void set_huge_pages(bool on) {
+    huge_pages_ref().store(on, std::memory_order_relaxed);
+}
+
+// Cumulative counts of large buffers since start: advised for huge pages
+// (and their bytes), and those left on small pages.
+struct HugePageStats {
+    u64 advised_buffers;
+    u64 advised_bytes;
+    u64 fallback_buffers;
+};
+
+inline std::atomic<u64>* huge_page_counters() {
+    static std::atomic<u64> c[3] = {};
+    return c;
+}
+
+inline HugePageStats huge_page_stats() {
+    const std::atomic<u64>* c = huge_page_counters();
+    return {c[0].load(std::memory_order_relaxed), c[1].load(std::memory_order_relaxed),
+            c[2].load(std::memory_order_relaxed)};
+}
+
+// Bytes of this process's anonymous memory currently on huge pages
+// (AnonHugePages of /proc/self/smaps_rollup; 0 where unavailable).  What
+// actually landed on huge pages, as opposed to what was advised.
+inline u64 huge_pages_resident_bytes() {
+    u64 kb = 0;
+#if defined(__linux__)
+    if (FILE* f = std::fopen("/proc/self/smaps_rollup", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), f)) {
+            unsigned long long v;
+            if (std::sscanf(line, "AnonHugePages: %llu kB", &v) == 1) { kb = v; break; }
+        }
+        std::fclose(f);
+    }
+#endif
+    return kb * 1024;
+}
+
 #if defined(_MSC_VER)
-  #include <malloc.h>
-  template<class T, idt Align = 32>
-  inline T* aligned_alloc_array(idt n) {
-      return static_cast<T*>(_aligned_malloc(n * sizeof(T), Align));
+  inline void* aligned_alloc_bytes(idt bytes, idt align) {
+      if (bytes >= HUGE_PAGE_MIN_BYTES && huge_pages())
+          huge_page_counters()[2].fetch_add(1, std::memory_order_relaxed);
+      return _aligned_malloc(bytes, align);
   }
-  template<class T, idt Align = 32>
-  inline void aligned_free_array(T* p) {
+  inline void aligned_free_bytes(void* p) {
       _aligned_free(p);
   }
 #else
-  #include <cstdlib>
-  template<class T, idt Align = 32>
-  inline T* aligned_alloc_array(idt n) {
+  inline void* aligned_alloc_bytes(idt bytes, idt align) {
+      const bool huge = bytes >= HUGE_PAGE_MIN_BYTES && huge_pages();
+      if (huge && align < HUGE_PAGE_BYTES) align = HUGE_PAGE_BYTES;
       void* ptr = nullptr;
-      posix_memalign(&ptr, Align, n * sizeof(T));
-      return static_cast<T*>(ptr);
+      if (posix_memalign(&ptr, align, bytes) != 0) return nullptr;
+      if (huge) {
+          bool advised = false;
+  #if defined(__linux__) && defined(MADV_HUGEPAGE)
+          const idt len = bytes & ~(HUGE_PAGE_BYTES - 1);
+          advised = madvise(ptr, len, MADV_HUGEPAGE) == 0;
+  #endif
+          std::atomic<u64>* c = huge_page_counters();
+          if (advised) {
+              c[0].fetch_add(1, std::memory_order_relaxed);
+              c[1].fetch_add(bytes & ~(HUGE_PAGE_BYTES - 1), std::memory_order_relaxed);
+          } else {
+              c[2].fetch_add(1, std::memory_order_relaxed);
+          }
+      }
+      return ptr;
   }
-  template<class T, idt Align = 32>
-  inline void aligned_free_array(T* p) {
+  inline void aligned_free_bytes(void* p) {
       std::free(p);
   }
 #endif
 
+template<class T, idt Align = 32>
+inline T* aligned_alloc_array(idt n) {
+    return static_cast<T*>(aligned_alloc_bytes(n * sizeof(T), Align));
+}
+template<class T, idt Align = 32>
+inline void aligned_free_array(T* p) {
+    aligned_free_bytes(p);
+}
+
 // ── Ceil to power of 2 ──
 inline idt ceil_pow2(idt x) {
     if (x < 2) return 1;
     return idt(1) << (ntt_lg((unsigned)(x - 1)) + 1);
 }
 
-// ── Ceil to smooth number {4,5,6}*2^n ──
-// Max NTT size: 3*2^23 limbs (CRT overflow beyond this).
+// ── Ceil to smooth number {4,5,6,7.5}*2^n ──
+// Max NTT size: 3*2^24 limbs.  The primes' 2^23 roots of unity suffice
+// since the twisted leaf convolutions absorb the last few radix-2 levels; the
+// CRT bound on the inputs is checked by the callers (see api.hpp).
 // Entries where mixed-radix sub_n < 4 vecs are omitted (twisted_conv needs batch-of-4).
 // Minimum valid mixed-radix: 96 (m=3, sub_n=4 vecs), 160 (m=5, sub_n=4 vecs).
+// 15*2^k (radix-15 outer pass) only pays for itself once the transform no
+// longer fits in cache; below 2^24 it is slower than rounding up to 2^(k+4).
+// So only 15728640 and 31457280 are listed.  Elsewhere the gaps between
+// 4/5/6/8 * 2^k are closed by the truncated power-of-2 transform instead
+// (product_size_for in api.hpp), whose cost grows with the product length.
+// A prime set with 9 | p-1 (e.g. 225*2^22+1 for P0) would add 9*2^k, but
+// only with 2^22 roots, and a radix-9 pass costs about what the 10*2^k
+// length it saves does, more than the truncated 2^(k+4).
 static constexpr idt SMOOTH_TABLE[] = {
     4,
     8,
@@ -202,8 +323,9 @@ static constexpr idt SMOOTH_TABLE[] = {
     1048576, 1310720, 1572864,
     2097152, 2621440, 3145728,
     4194304, 5242880, 6291456,
-    8388608, 10485760, 12582912,
-    16777216, 20971520, 25165824,
+    8388608, 10485760, 12582912, 15728640,
+    16777216, 20971520, 25165824, 31457280,
+    33554432, 41943040, 50331648,
 };
 static constexpr int SMOOTH_TABLE_SIZE = sizeof(SMOOTH_TABLE) / sizeof(SMOOTH_TABLE[0]);
 
@@ -215,7 +337,8 @@ inline idt ceil_smooth(idt x) {
         if (SMOOTH_TABLE[mid] < x) lo = mid + 1;
         else hi = mid;
     }
-    return SMOOTH_TABLE[lo];  // lo == SMOOTH_TABLE_SIZE only if x > max (shouldn't happen)
+    // Past the last entry: larger than any size limit the callers test against
+    return lo < SMOOTH_TABLE_SIZE ? SMOOTH_TABLE[lo] : ~idt(0);
 }
 
 // ── Constants ──
@@ -1,5 +1,7 @@
 #pragma once
 #include "../common.hpp"
+#include "mont_scalar.hpp"
+#include "mont_vec.hpp"
 
 namespace ntt {
 
@@ -52,7 +54,12 @@ static constexpr u128 CRT_PRODUCT = {0x11CC400078000001ULL, 0x0000000000CFA440UL
 static constexpr double CRT_INV_HI = 0x1.3b9ee9fe0e109p-24;
 
 // ── Per-coefficient CRT recovery ──
+// Residues may be lazily reduced (n_i in [0, 2*P_i), as a lazy inverse NTT
+// leaves them); they are normalized here.
 NTT_FORCEINLINE u128 crt_recover(u32 n0, u32 n1, u32 n2) {
+    if (n0 >= CRT_P0) n0 -= CRT_P0;
+    if (n1 >= CRT_P1) n1 -= CRT_P1;
+    if (n2 >= CRT_P2) n2 -= CRT_P2;
     u128 sum = n0 * CRT_PI0 + n1 * CRT_PI1 + n2 * CRT_PI2;
     u32 q = (u32)((double)sum.hi * CRT_INV_HI);
     u128 r = sum - q * CRT_PRODUCT;
@@ -61,7 +68,8 @@ NTT_FORCEINLINE u128 crt_recover(u32 n0, u32 n1, u32 n2) {
 }
 
 // ── CRT + carry propagation for big integer multiplication ──
-inline void crt_and_propagate(
+// Scalar reference: one crt_recover per coefficient.
+inline void crt_and_propagate_scalar(
     u32* out, idt len,
     const u32* r0, const u32* r1, const u32* r2)
 {
@@ -78,4 +86,234 @@ inline void crt_and_propagate(
     // For proper big-integer multiply the caller should ensure enough space
 }
 
+// ── Garner constants (Montgomery form, for mont_mul_bsm) ──
+// C01 = P0^-1 mod P1, C02 = P0^-1 mod P2, C12 = P1^-1 mod P2
+struct CrtGarner {
+    static constexpr MontScalar ms1{CRT_P1};
+    static constexpr MontScalar ms2{CRT_P2};
+    static constexpr u32 C01 = ms1.power_s(ms1.to_mont(CRT_P0 % CRT_P1), CRT_P1 - 2, ms1.one);
+    static constexpr u32 C02 = ms2.power_s(ms2.to_mont(CRT_P0 % CRT_P2), CRT_P2 - 2, ms2.one);
+    static constexpr u32 C12 = ms2.power_s(ms2.to_mont(CRT_P1 % CRT_P2), CRT_P2 - 2, ms2.one);
+};
+
+// Outputs at least this long (u32 limbs) and 32-byte aligned are written
+// with streaming stores: they are larger than the caches anyway.
+static constexpr idt CRT_STREAM_MIN = idt(1) << 20;
+
+// AVX2 Garner CRT, 8 coefficients per step, inputs in [0, 2*P_i) shrunk
+// to [0, P_i) on load:
+//   v1 = (r1 - r0) * C01 mod P1
+//   v2 = ((r2 - r0) * C02 - v1) * C12 mod P2
+//   x  = r0 + P0 * (v1 + P1 * v2)                 (< P0*P1*P2 < 2^88)
+// x is split into three u32 words w0..w2 for the BLK = 64 coefficients at
+// r0, r1, r2.  HAS_V1: r1 holds the finished first Garner digit v1
+// (crt_garner_v1) rather than the P1 residues.
+struct CrtBlock {
+    static constexpr idt BLK = 64;
+
+    using B = Avx2;
+    using Vec = B::Vec;
+
+    const MontVec<B> m1{CRT_P1, CrtGarner::ms1.niv, 0};
+    const MontVec<B> m2{CRT_P2, CrtGarner::ms2.niv, 0};
+    const Vec c01 = B::broadcast(CrtGarner::C01);
+    const Vec c02 = B::broadcast(CrtGarner::C02);
+    const Vec c12 = B::broadcast(CrtGarner::C12);
+    // Offsets keeping the differences non-negative: 2P1 > P0, 3P2 > P0,
+    // and 2P2 > P1 >= v1
+    const Vec p1x2 = B::broadcast(2 * CRT_P1);
+    const Vec p2x3 = B::broadcast(3 * CRT_P2);
+    const Vec p2x2 = B::broadcast(2 * CRT_P2);
+    const Vec vP0 = B::broadcast(CRT_P0);
+    const Vec vP1 = B::broadcast(CRT_P1);
+    const Vec vP2 = B::broadcast(CRT_P2);
+    const Vec lo32 = _mm256_set1_epi64x(0xffffffffLL);
+
+    template<bool HAS_V1>
+    NTT_FORCEINLINE void words(u32* w0, u32* w1, u32* w2,
+                               const u32* r0, const u32* r1, const u32* r2) const {
+        for (idt k = 0; k < BLK; k += B::LANES) {
+            Vec x0 = B::loadu(r0 + k);
+            Vec x2 = B::loadu(r2 + k);
+            x0 = B::min32(x0, B::sub32(x0, vP0));
+            x2 = B::min32(x2, B::sub32(x2, vP2));
+
+            Vec v1;
+            if constexpr (HAS_V1) {
+                v1 = B::loadu(r1 + k);
+            } else {
+                Vec x1 = B::loadu(r1 + k);
+                x1 = B::min32(x1, B::sub32(x1, vP1));
+                v1 = m1.shrink(m1.mont_mul_bsm(B::add32(x1, B::sub32(p1x2, x0)), c01));
+            }
+            const Vec u2 = m2.mont_mul_bsm(B::add32(x2, B::sub32(p2x3, x0)), c02);
+            const Vec v2 = m2.shrink(m2.mont_mul_bsm(B::add32(u2, B::sub32(p2x2, v1)), c12));
+
+            // y = v1 + P1 * v2 (< 2^59), even and odd lanes as u64
+            const Vec ye = B::add64(B::mul64(v2, vP1), _mm256_and_si256(v1, lo32));
+            const Vec yo = B::add64(B::mul64(B::srl64(v2, 32), vP1), B::srl64(v1, 32));
+            // x = v0 + P0 * y: low = v0 + P0 * y_lo, high = P0 * y_hi + carry(low)
+            const Vec le = B::add64(B::mul64(ye, vP0), _mm256_and_si256(x0, lo32));
+            const Vec lo = B::add64(B::mul64(yo, vP0), B::srl64(x0, 32));
+            const Vec he = B::add64(B::mul64(B::srl64(ye, 32), vP0), B::srl64(le, 32));
+            const Vec ho = B::add64(B::mul64(B::srl64(yo, 32), vP0), B::srl64(lo, 32));
+
+            B::store(w0 + k, B::blend_0xaa(le, _mm256_slli_epi64(lo, 32)));
+            B::store(w1 + k, B::blend_0xaa(he, _mm256_slli_epi64(ho, 32)));
+            B::store(w2 + k, B::blend_0xaa(B::srl64(he, 32), ho));
+        }
+    }
+};
+
+// CRT + carry propagation: a scalar pass per block of CrtBlock adds the x
+// words into the output with the running carry (same carry as the scalar
+// path).  out may equal r0 (each block is read before written).  Returns the
+// carry out of out[len - 1].
+template<bool HAS_V1>
+inline u64 crt_propagate_impl(
+    u32* out, idt len,
+    const u32* r0, const u32* r1, const u32* r2)
+{
+    using B = Avx2;
+    using Vec = B::Vec;
+    constexpr idt BLK = CrtBlock::BLK;
+
+    const CrtBlock crt;
+    const bool stream = len >= CRT_STREAM_MIN && (reinterpret_cast<uintptr_t>(out) & 31) == 0;
+
+    alignas(32) u32 w0[BLK], w1[BLK], w2[BLK], ob[BLK];
+    u64 carry = 0;
+    idt i = 0;
+    for (; i + BLK <= len; i += BLK) {
+        crt.words<HAS_V1>(w0, w1, w2, r0 + i, r1 + i, r2 + i);
+
+        u32* dst = stream ? ob : out + i;
+        for (idt k = 0; k < BLK; ++k) {
+            const u64 s = u64(w0[k]) + u32(carry);
+            carry = (carry >> 32) + w1[k] + (u64(w2[k]) << 32) + (s >> 32);
+            dst[k] = u32(s);
+        }
+        if (stream) {
+            for (idt k = 0; k < BLK; k += B::LANES)
+                _mm256_stream_si256((Vec*)(out + i + k), B::load(ob + k));
+        }
+    }
+    if (stream) _mm_sfence();
+
+    // Tail: scalar reference recovery, same carry
+    for (; i < len; ++i) {
+        u32 n1 = r1[i];
+        if constexpr (HAS_V1) {
+            // Back to the P1 residue: r0 + P0 * v1 mod P1
+            const u32 n0 = (r0[i] >= CRT_P0) ? r0[i] - CRT_P0 : r0[i];
+            n1 = u32((n0 + u64(CRT_P0) * n1) % CRT_P1);
+        }
+        u128 val = crt_recover(r0[i], n1, r2[i]);
+        u64 new_lo = val.lo + carry;
+        u64 new_hi = val.hi + (new_lo < val.lo);
+        out[i] = (u32)new_lo;
+        carry = (new_lo >> 32) | (new_hi << 32);
+    }
+    return carry;
+}
+
+inline u64 crt_and_propagate(
+    u32* out, idt len,
+    const u32* r0, const u32* r1, const u32* r2)
+{
+    return crt_propagate_impl<false>(out, len, r0, r1, r2);
+}
+
+// ── Incremental Garner (low-memory multiplication) ──
+// The primes finish one at a time, so only the digits still needed are kept:
+// after P0 its residues r0; after P1 the first Garner digit
+//   v1 = (r1 - r0) * C01 mod P1                     (in [0, P1))
+// which crt_and_propagate_v1 then combines with r2.  Residues may be lazy.
+inline void crt_garner_v1(u32* v1, idt len, const u32* r0, const u32* r1) {
+    using B = Avx2;
+    using Vec = B::Vec;
+
+    const MontVec<B> m1(CRT_P1, CrtGarner::ms1.niv, 0);
+    const Vec c01 = B::broadcast(CrtGarner::C01);
+    const Vec p1x2 = B::broadcast(2 * CRT_P1);
+    const Vec vP0 = B::broadcast(CRT_P0);
+    const Vec vP1 = B::broadcast(CRT_P1);
+
+    idt i = 0;
+    for (; i + B::LANES <= len; i += B::LANES) {
+        Vec x0 = B::loadu(r0 + i);
+        Vec x1 = B::loadu(r1 + i);
+        x0 = B::min32(x0, B::sub32(x0, vP0));
+        x1 = B::min32(x1, B::sub32(x1, vP1));
+        _mm256_storeu_si256((Vec*)(v1 + i),
+                            m1.shrink(m1.mont_mul_bsm(B::add32(x1, B::sub32(p1x2, x0)), c01)));
+    }
+    for (; i < len; ++i) {
+        const u32 n0 = (r0[i] >= CRT_P0) ? r0[i] - CRT_P0 : r0[i];
+        const u32 n1 = (r1[i] >= CRT_P1) ? r1[i] - CRT_P1 : r1[i];
+        v1[i] = CrtGarner::ms1.mul_s(n1 + 2 * CRT_P1 - n0, CrtGarner::C01);
+    }
+}
+
+// crt_and_propagate from r0, the digit v1 of crt_garner_v1, and r2.
+// out may equal r0.
+inline u64 crt_and_propagate_v1(
+    u32* out, idt len,
+    const u32* r0, const u32* v1, const u32* r2)
+{
+    return crt_propagate_impl<true>(out, len, r0, v1, r2);
+}
+
+// ── CRT + carry propagation in base 2^bits ──
+// For products of narrow coefficients (bits < 32, see big_multiply_narrow):
+// coefficient k, with residues r0/r1/r2[k] for k < len, weighs 2^(bits k).
+// The normalized digits are packed LSB-first into out[0..out_len), the carry
+// past coefficient len - 1 is flushed into the limbs after it, and whatever
+// falls beyond out_len is dropped.
+inline void crt_and_propagate_bits(
+    u64* out, idt out_len,
+    const u32* r0, const u32* r1, const u32* r2, idt len, int bits)
+{
+    constexpr idt BLK = CrtBlock::BLK;
+    // x + carry < 2^89, so the carry stays within a u64
+    assert(bits >= 26 && bits < 32);
+
+    const u64 mask = (u64(1) << bits) - 1;
+    u64 carry = 0;
+    u64 acc = 0;    // pending low bits of out[o]
+    int fill = 0;
+    idt o = 0;
+    auto put = [&](u64 lo, u64 hi) {
+        lo += carry;
+        hi += (lo < carry);
+        const u64 d = lo & mask;
+        carry = (lo >> bits) | (hi << (64 - bits));
+        acc |= d << fill;
+        fill += bits;
+        if (fill >= 64) {
+            out[o++] = acc;
+            fill -= 64;
+            acc = d >> (bits - fill);
+        }
+    };
+
+    const CrtBlock crt;
+    alignas(32) u32 w0[BLK], w1[BLK], w2[BLK];
+    idt i = 0;
+    for (; i + BLK <= len && o < out_len; i += BLK) {
+        crt.words<false>(w0, w1, w2, r0 + i, r1 + i, r2 + i);
+        for (idt k = 0; k < BLK && o < out_len; ++k)
+            put(w0[k] | u64(w1[k]) << 32, w2[k]);
+    }
+    for (; i < len && o < out_len; ++i) {
+        const u128 val = crt_recover(r0[i], r1[i], r2[i]);
+        put(val.lo, val.hi);
+    }
+    while (carry && o < out_len) put(0, 0);
+    if (o < out_len) {
+        out[o++] = acc;
+        std::memset(out + o, 0, (out_len - o) * sizeof(u64));
+    }
+}
+
 } // namespace ntt
@@ -3,11 +3,12 @@
 #include "mont_scalar.hpp"
 #include "mont_vec.hpp"
 #include "../simd/avx2.hpp"
+#include "../simd/avx512.hpp"
 #include <array>
 
 namespace ntt {
 
-// Cyclic convolution at SIMD width (8-point for AVX2).
+// Cyclic convolution at SIMD width (8-point for AVX2, 16-point for AVX-512).
 // Direct port of __conv8, __conv8_4, __vec_cvdt8 from ref.cpp
 template<typename B>
 struct CyclicConv;
@@ -19,7 +20,8 @@ struct CyclicConv<Avx2> {
     // Full twisted convolution over n Vecs.
     // Port of __vec_cvdt8 from ref.cpp.
     // Iterates with ruler-sequence twiddle updates, calling conv8_batch4 in groups of 4.
-    static void twisted_conv(Vec* f, Vec* g, idt n,
+    // g is only read, so one spectrum may be shared by concurrent calls.
+    static void twisted_conv(Vec* f, const Vec* g, idt n,
                               const MontScalar& ms, u32 img, const u32* RT3,
                               u32 rr_init = 0)
     {
@@ -32,7 +34,7 @@ struct CyclicConv<Avx2> {
         for (idt i = 0; i < n; i += 4) {
             const u32 RRi = ms.mul(RR, img);
             conv8_batch4(
-                (u32*)(f + i), (u32*)(g + i),
+                (u32*)(f + i), (const u32*)(g + i),
                 {RR, mod2_ - RR, RRi, mod2_ - RRi},
                 vNiv, vMod, vMod2);
             RR = ms.mul(RR, RT3[ntt_ctzll(i + 4)]);
@@ -104,18 +106,19 @@ struct CyclicConv<Avx2> {
     // Batch of 4 twisted convolutions
     // Direct port of __conv8_4
     static void conv8_batch4(
-        u32* NTT_RESTRICT f, u32* NTT_RESTRICT g,
+        u32* NTT_RESTRICT f, const u32* NTT_RESTRICT g_in,
         std::array<u32, 4> ww,
         Vec Niv, Vec Mod, Vec Mod2)
     {
         alignas(64) u32 awa[4][16];
+        alignas(64) u32 g[32];  // g_in normalized to [0, M)
         alignas(64) Vec res0[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(),
                                     _mm256_setzero_si256(), _mm256_setzero_si256()};
         alignas(64) Vec res1[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(),
                                     _mm256_setzero_si256(), _mm256_setzero_si256()};
 
         for (int i = 0; i < 4; ++i) {
-            Vec gg = _mm256_load_si256((const Vec*)(g + i * 8));
+            Vec gg = _mm256_load_si256((const Vec*)(g_in + i * 8));
             gg = shrk(shrk(gg, Mod2), Mod);
             _mm256_store_si256((Vec*)(g + i * 8), gg);
 
@@ -167,4 +170,103 @@ private:
     }
 };
 
+#ifdef NTT_HAS_AVX512
+template<>
+struct CyclicConv<Avx512> {
+    using Vec = __m512i;
+
+    // Same root chain as CyclicConv<Avx2>::twisted_conv; only the base
+    // case is wider (x^16 - w per Vec).
+    static void twisted_conv(Vec* f, const Vec* g, idt n,
+                              const MontScalar& ms, u32 img, const u32* RT3,
+                              u32 rr_init = 0)
+    {
+        u32 RR = rr_init ? rr_init : ms.one;
+        const u32 mod2_ = ms.mod2;
+        const Vec vNiv = _mm512_set1_epi32((i32)ms.niv);
+        const Vec vMod = _mm512_set1_epi32((i32)ms.mod);
+        const Vec vMod2 = _mm512_set1_epi32((i32)mod2_);
+
+        for (idt i = 0; i < n; i += 4) {
+            const u32 RRi = ms.mul(RR, img);
+            conv16_batch4(
+                (u32*)(f + i), (const u32*)(g + i),
+                {RR, mod2_ - RR, RRi, mod2_ - RRi},
+                vNiv, vMod, vMod2);
+            RR = ms.mul(RR, RT3[ntt_ctzll(i + 4)]);
+        }
+    }
+
+    // Batch of 4 twisted convolutions f = f * g mod (x^16 - ww[i]).
+    // Same scheme as conv8_batch4: each shifted operand is an unaligned
+    // load from [f*w | f], so no cross-lane shuffles are needed.
+    // 16 products < M^2 accumulate to < 16M^2; after Montgomery reduction
+    // the result is below (16M/2^32 + 1)M, up to ~4.3M for P0, hence the
+    // extra 4M shrink before the usual one.
+    static void conv16_batch4(
+        u32* NTT_RESTRICT f, const u32* NTT_RESTRICT g_in,
+        std::array<u32, 4> ww,
+        Vec Niv, Vec Mod, Vec Mod2)
+    {
+        alignas(64) u32 awa[4][32];
+        alignas(64) u32 g[64];  // g_in normalized to [0, M)
+        Vec res0[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(),
+                       _mm512_setzero_si512(), _mm512_setzero_si512()};
+        Vec res1[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(),
+                       _mm512_setzero_si512(), _mm512_setzero_si512()};
+        const Vec Mod4 = _mm512_add_epi32(Mod2, Mod2);
+
+        for (int i = 0; i < 4; ++i) {
+            Vec gg = _mm512_load_si512(g_in + i * 16);
+            gg = shrk(shrk(gg, Mod2), Mod);
+            _mm512_store_si512(g + i * 16, gg);
+
+            Vec ff = _mm512_load_si512(f + i * 16);
+            ff = shrk(ff, Mod2);
+            Vec wv = _mm512_set1_epi32((i32)ww[i]);
+            Vec ffw = shrk(mul_bsm(ff, wv, Niv, Mod), Mod);
+            ff = shrk(ff, Mod);
+            _mm512_store_si512(awa[i], ffw);
+            _mm512_store_si512(awa[i] + 16, ff);
+        }
+
+        for (int i = 0; i < 16; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                Vec bi = _mm512_set1_epi32((i32)g[j * 16 + i]);
+                Vec aj = _mm512_loadu_si512(awa[j] + 16 - i);
+                Vec aj2 = _mm512_srli_epi64(aj, 32);
+                res0[j] = _mm512_add_epi64(res0[j], _mm512_mul_epu32(bi, aj));
+                res1[j] = _mm512_add_epi64(res1[j], _mm512_mul_epu32(bi, aj2));
+            }
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            Vec reduced = mont_reduce_raw(res0[i], res1[i], Niv, Mod);
+            _mm512_store_si512(f + i * 16, shrk(shrk(reduced, Mod4), Mod2));
+        }
+    }
+
+private:
+    NTT_FORCEINLINE static Vec shrk(Vec x, Vec M) {
+        return _mm512_min_epu32(x, _mm512_sub_epi32(x, M));
+    }
+
+    NTT_FORCEINLINE static Vec mul_bsm(Vec a, Vec b, Vec niv, Vec mod) {
+        Vec even = _mm512_mul_epu32(a, b);
+        Vec odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), b);
+        return mont_reduce_raw(even, odd, niv, mod);
+    }
+
+    NTT_FORCEINLINE static Vec mont_reduce_raw(Vec even, Vec odd, Vec niv, Vec mod) {
+        Vec ce = _mm512_mul_epu32(even, niv);
+        Vec co = _mm512_mul_epu32(odd, niv);
+        ce = _mm512_mul_epu32(ce, mod);
+        co = _mm512_mul_epu32(co, mod);
+        return _mm512_mask_blend_epi32(0xaaaa,
+            _mm512_srli_epi64(_mm512_add_epi64(even, ce), 32),
+            _mm512_add_epi64(odd, co));
+    }
+};
+#endif // NTT_HAS_AVX512
+
 } // namespace ntt
@@ -0,0 +1,171 @@
+#pragma once
+#include "../common.hpp"
+#include "mont_vec.hpp"
+#include "root_plan.hpp"
+
+namespace ntt {
+
+// Radix-15 outer DIF/DIT passes for mixed-radix NTT.
+// Applied once as the outermost layer when n = 15 * 2^k.  15 divides P - 1
+// for all three primes, while radix 9 and 7 cannot be shared by them:
+// P0 - 1 = 105 * 2^23 lacks the factor 9, and only P0 - 1 has the factor 7
+// (P1 - 1 = 90 * 2^23, P2 - 1 = 45 * 2^23).  The 15-point DFT of each column
+// is a Good-Thomas 3 x 5 split, so it needs no inner twiddles: input row
+// 5*r1 + 3*r2 (mod 15) feeds radix-5 butterfly r1, and radix-3 butterfly r2
+// of those results yields output row 10*s1 + 6*s2 (mod 15).  With
+// ω_3 = ω_15^5 and ω_5 = ω_15^3 both are the butterflies of Radix3Kernel
+// and Radix5Kernel.  One pass over the data does the whole outer stage.
+template<typename B, u32 Mod>
+struct Radix15Kernel {
+    using Vec = typename B::Vec;
+    using MV = MontVec<B>;
+    static constexpr MontScalar ms{Mod};
+
+    // Butterfly constants of the 3- and 5-point DFTs
+    struct Consts {
+        Vec neg_half, j3h;
+        Vec c1h, c2h, c12h, j1h, j2h, j12s;
+
+        explicit Consts(const RootPlan<Mod>& roots)
+            : neg_half(B::broadcast(roots.neg_half)),
+              j3h(B::broadcast(roots.j3_half)),
+              c1h(B::broadcast(roots.c1h)),
+              c2h(B::broadcast(roots.c2h)),
+              c12h(B::broadcast(ms.shrink(roots.c1h + roots.c2h))),
+              j1h(B::broadcast(roots.j1h)),
+              j2h(B::broadcast(roots.j2h)),
+              j12s(B::broadcast(ms.shrink(roots.j1h + roots.j2h))) {}
+    };
+
+    // 5-point DFT of (a, b, cc, d, e) into y[0..5).  INV uses ω_5^-1
+    // (outputs 1 <-> 4, 2 <-> 3).  Inputs in [0, 2M), outputs in [0, 2M).
+    template<bool INV>
+    NTT_FORCEINLINE static void bfly5(const MV& m, const Consts& c,
+                                      Vec a, Vec b, Vec cc, Vec d, Vec e, Vec* y) {
+        const Vec s1 = m.add2(b, e);
+        const Vec t1 = m.sub2(b, e);
+        const Vec s2 = m.add2(cc, d);
+        const Vec t2 = m.sub2(cc, d);
+
+        y[0] = m.add2(a, m.add2(s1, s2));
+
+        const Vec p1 = m.mont_mul_bsm(s1, c.c1h);
+        const Vec p2 = m.mont_mul_bsm(s2, c.c2h);
+        const Vec p3 = m.mont_mul_bsm(m.add2(s1, s2), c.c12h);
+        const Vec pp = m.add2(p1, p2);
+        const Vec alpha = m.add2(a, pp);
+        const Vec gamma = m.add2(a, m.sub2(p3, pp));
+
+        const Vec q1 = m.mont_mul_bsm(t1, c.j1h);
+        const Vec q2 = m.mont_mul_bsm(t2, c.j2h);
+        const Vec q3 = m.mont_mul_bsm(m.sub2(t1, t2), c.j12s);
+        const Vec beta = m.add2(q1, q2);
+        const Vec delta = m.add2(m.sub2(q3, q1), q2);
+
+        y[INV ? 4 : 1] = m.add2(alpha, beta);
+        y[INV ? 3 : 2] = m.add2(gamma, delta);
+        y[INV ? 2 : 3] = m.sub2(gamma, delta);
+        y[INV ? 1 : 4] = m.sub2(alpha, beta);
+    }
+
+    // 3-point DFT; INV uses ω_3^-1 (outputs 1 <-> 2).
+    template<bool INV>
+    NTT_FORCEINLINE static void bfly3(const MV& m, const Consts& c,
+                                      Vec a, Vec b, Vec cc, Vec* y) {
+        const Vec s = m.add2(b, cc);
+        const Vec d = m.sub2(b, cc);
+        const Vec hs = m.mont_mul_bsm(s, c.neg_half);
+        const Vec jd = m.mont_mul_bsm(d, c.j3h);
+        const Vec ahs = m.add2(a, hs);
+        y[0] = m.add2(a, s);
+        y[INV ? 2 : 1] = m.add2(ahs, jd);
+        y[INV ? 1 : 2] = m.sub2(ahs, jd);
+    }
+
+    // 15-point DFT of x[0..15) in place (row order in, row order out)
+    template<bool INV>
+    NTT_FORCEINLINE static void dft15(const MV& m, const Consts& c, Vec* x) {
+        Vec y[3][5];
+        for (int r1 = 0; r1 < 3; ++r1) {
+            const int o = 5 * r1;
+            bfly5<INV>(m, c, x[o % 15], x[(o + 3) % 15], x[(o + 6) % 15],
+                       x[(o + 9) % 15], x[(o + 12) % 15], y[r1]);
+        }
+        for (int s2 = 0; s2 < 5; ++s2) {
+            Vec z[3];
+            bfly3<INV>(m, c, y[0][s2], y[1][s2], y[2][s2], z);
+            for (int s1 = 0; s1 < 3; ++s1) x[(10 * s1 + 6 * s2) % 15] = z[s1];
+        }
+    }
+
+    // DIF pass: split n vecs into 15 sub-arrays of sub_n = n/15.
+    // Inputs in [0, 2M), outputs in [0, 2M).
+    // [j_begin, j_end) restricts the pass to a slice of the sub_n columns
+    // (columns are independent; used to split the pass across threads).
+    // Input rows live..14 of those columns are known zero (need not be
+    // initialized).
+    static void dif_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 15) {
+        const idt sub_n = n / 15;
+        if (j_end > sub_n) j_end = sub_n;
+        const int k = ntt_ctzll(sub_n);
+        const Consts c(roots);
+
+        // Row s of column j is scaled by ω_N^(s*j).  The twiddles are the
+        // same in every lane, so ω_N^j and its powers are kept as scalars
+        // (lazy, in [0, 2M)) off the vector ports and broadcast.
+        const u32 tw_root_s = roots.tw15_root[k];
+        u32 tw1 = ms.power_s(tw_root_s, u32(j_begin), ms.one);
+
+        for (idt j = j_begin; j < j_end; ++j) {
+            Vec x[15];
+            for (int r = 0; r < 15; ++r)
+                x[r] = (r < live) ? B::load(f + j + r * sub_n) : B::zero();
+
+            dft15<false>(m, c, x);
+
+            B::store(f + j, x[0]);
+            u32 tw = tw1;
+            for (int s = 1; s < 15; ++s) {
+                B::store(f + j + s * sub_n, m.mont_mul_bsm(x[s], B::broadcast(tw)));
+                tw = ms.mul(tw, tw1);
+            }
+            tw1 = ms.mul(tw1, tw_root_s);
+        }
+    }
+
+    // DIT pass: inverse of DIF, fuses 1/15 scale.
+    // Inputs in [0, 2M) (from a lazy inv_b2), outputs in [0, M) (with final shrink).
+    // Output rows live..14 are not needed and are left unwritten.
+    static void dit_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 15) {
+        const idt sub_n = n / 15;
+        if (j_end > sub_n) j_end = sub_n;
+        const int k = ntt_ctzll(sub_n);
+        const Consts c(roots);
+
+        const u32 inv15 = ms.mul_s(roots.inv3, roots.inv5);
+        const Vec inv15_v = B::broadcast(inv15);
+        const u32 tw_inv_root_s = roots.tw15i_root[k];
+        u32 tw1 = ms.power_s(tw_inv_root_s, u32(j_begin), ms.one);
+
+        for (idt j = j_begin; j < j_end; ++j) {
+            // Scale + undo twiddle (fused): row s times ω_N^(-s*j) / 15
+            Vec x[15];
+            u32 tw = ms.mul(tw1, inv15);
+            x[0] = m.mont_mul_bsm(B::load(f + j), inv15_v);
+            for (int s = 1; s < 15; ++s) {
+                x[s] = m.mont_mul_bsm(B::load(f + j + s * sub_n), B::broadcast(tw));
+                tw = ms.mul(tw, tw1);
+            }
+
+            dft15<true>(m, c, x);
+
+            for (int r = 0; r < live; ++r)
+                B::store(f + j + r * sub_n, m.shrink(x[r]));
+            tw1 = ms.mul(tw1, tw_inv_root_s);
+        }
+    }
+};
+
+} // namespace ntt
@@ -12,30 +12,87 @@ struct Radix2Kernel {
     // DIF radix-2 pass: half = n/2 Vecs
     // Inputs in [0, 2M), outputs: p0 [0,2M), p1 [0,4M)
     NTT_FORCEINLINE static void dif_pass(Vec* f, idt half, const M& m) {
-        for (idt i = 0; i < half; ++i) {
-            Vec* p0 = f + i;
-            Vec* p1 = f + half + i;
-            const Vec f0 = B::load(p0);
-            const Vec f1 = B::load(p1);
+        dif_butterfly(f, f + half, half, m);
+    }
+
+    // Same butterfly over len Vecs at p0[i], p1[i] (a slice of dif_pass).
+    // live < 2: p1 is known zero (and need not be initialized).
+    NTT_FORCEINLINE static void dif_butterfly(Vec* p0, Vec* p1, idt len, const M& m,
+                                              int live = 2) {
+        if (live < 2) {
+            for (idt i = 0; i < len; ++i) B::store(p1 + i, B::load(p0 + i));
+            return;
+        }
+        for (idt i = 0; i < len; ++i) {
+            const Vec f0 = B::load(p0 + i);
+            const Vec f1 = B::load(p1 + i);
             const Vec g0 = m.add2(f0, f1);
             const Vec g1 = m.lazy_sub(f0, f1);
-            B::store(p0, g0);
-            B::store(p1, g1);
+            B::store(p0 + i, g0);
+            B::store(p1 + i, g1);
         }
     }
 
     // DIT radix-2 pass: half = n/2 Vecs, with final shrink to [0, M)
     // Inputs may be in [0, 2M)
     NTT_FORCEINLINE static void dit_pass(Vec* f, idt half, const M& m) {
-        for (idt i = 0; i < half; ++i) {
-            Vec* p0 = f + i;
-            Vec* p1 = f + half + i;
-            const Vec f0 = B::load(p0);
-            const Vec f1 = B::load(p1);
+        dit_butterfly(f, f + half, half, m);
+    }
+
+    // Same butterfly over len Vecs at p0[i], p1[i] (a slice of dit_pass).
+    // live < 2: the p1 outputs are not needed and are left unwritten.
+    NTT_FORCEINLINE static void dit_butterfly(Vec* p0, Vec* p1, idt len, const M& m,
+                                              int live = 2) {
+        if (live < 2) {
+            for (idt i = 0; i < len; ++i)
+                B::store(p0 + i, m.shrink(m.add2(B::load(p0 + i), B::load(p1 + i))));
+            return;
+        }
+        for (idt i = 0; i < len; ++i) {
+            const Vec f0 = B::load(p0 + i);
+            const Vec f1 = B::load(p1 + i);
             const Vec g0 = m.add2(f0, f1);
             const Vec g1 = m.sub2(f0, f1);
-            B::store(p0, m.shrink(g0));
-            B::store(p1, m.shrink(g1));
+            B::store(p0 + i, m.shrink(g0));
+            B::store(p1 + i, m.shrink(g1));
+        }
+    }
+
+    // ── Truncated inverse steps (see NTTScheduler::inverse_tft) ──
+    // p0/p1 are the halves y^h - d and y^h + d of a node y^2h - d^2, and
+    // (k, kniv) a broadcast Montgomery constant.  All values in [0, 2M).
+
+    // p0 += k * p1: with k = d a child-0 value from the node's coefficients
+    // lo = p0, hi = p1; with k = -d the way back.
+    NTT_FORCEINLINE static void tft_axpy(Vec* p0, const Vec* p1, idt len,
+                                         Vec k, Vec kniv, const M& m) {
+        for (idt i = 0; i < len; ++i)
+            B::store(p0 + i, m.add2(B::load(p0 + i),
+                                    m.mont_mul_precomp(B::load(p1 + i), k, kniv)));
+    }
+
+    // From a child-0 value c0 = p0 and the coefficient hi = p1 (k = d):
+    // lo = c0 - d*hi into p0 and the child-1 value lo - d*hi into p1.
+    NTT_FORCEINLINE static void tft_split(Vec* p0, Vec* p1, idt len,
+                                          Vec k, Vec kniv, const M& m) {
+        for (idt i = 0; i < len; ++i) {
+            const Vec t = m.mont_mul_precomp(B::load(p1 + i), k, kniv);
+            const Vec lo = m.sub2(B::load(p0 + i), t);
+            B::store(p0 + i, lo);
+            B::store(p1 + i, m.sub2(lo, t));
+        }
+    }
+
+    // Child values to coefficients: lo = (p0 + p1)/2, hi = (p0 - p1)/(2d),
+    // with (h, hniv) = 1/2 and (k, kniv) = 1/(2d).
+    NTT_FORCEINLINE static void tft_merge(Vec* p0, Vec* p1, idt len,
+                                          Vec h, Vec hniv, Vec k, Vec kniv,
+                                          const M& m) {
+        for (idt i = 0; i < len; ++i) {
+            const Vec f0 = B::load(p0 + i);
+            const Vec f1 = B::load(p1 + i);
+            B::store(p0 + i, m.mont_mul_precomp(m.lazy_add(f0, f1), h, hniv));
+            B::store(p1 + i, m.mont_mul_precomp(m.lazy_sub(f0, f1), k, kniv));
         }
     }
 };
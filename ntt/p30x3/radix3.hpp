@@ -15,8 +15,14 @@ struct Radix3Kernel {
 
     // DIF pass: split n vecs into 3 sub-arrays of sub_n = n/3.
     // Inputs in [0, 2M), outputs in [0, 2M).
-    static void dif_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots) {
+    // [j_begin, j_end) restricts the pass to a slice of the sub_n columns
+    // (columns are independent; used to split the pass across threads).
+    // Input rows live..2 of those columns are known zero (need not be
+    // initialized).
+    static void dif_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 3) {
         const idt sub_n = n / 3;
+        if (j_end > sub_n) j_end = sub_n;
         const int k = ntt_ctzll(sub_n);
 
         const Vec neg_half_v = B::broadcast(roots.neg_half);
@@ -28,10 +34,10 @@ struct Radix3Kernel {
         const Vec tw2_root_v = B::broadcast(tw2_root_s);
 
         // j = 0: no twiddle
-        {
+        if (j_begin == 0 && j_end > 0) {
             const Vec a = B::load(f);
-            const Vec b = B::load(f + sub_n);
-            const Vec c = B::load(f + 2 * sub_n);
+            const Vec b = (live > 1) ? B::load(f + sub_n) : B::zero();
+            const Vec c = (live > 2) ? B::load(f + 2 * sub_n) : B::zero();
 
             const Vec s = m.add2(b, c);
             const Vec d = m.sub2(b, c);
@@ -47,12 +53,13 @@ struct Radix3Kernel {
         }
 
         // j > 0: with twiddles
-        Vec tw = B::broadcast(tw_root_s);
-        Vec tw2 = B::broadcast(tw2_root_s);
-        for (idt j = 1; j < sub_n; ++j) {
+        const idt j0 = (j_begin > 1) ? j_begin : 1;
+        Vec tw = B::broadcast(ms.power_s(tw_root_s, u32(j0), ms.one));
+        Vec tw2 = B::broadcast(ms.power_s(tw2_root_s, u32(j0), ms.one));
+        for (idt j = j0; j < j_end; ++j) {
             const Vec a = B::load(f + j);
-            const Vec b = B::load(f + j + sub_n);
-            const Vec c = B::load(f + j + 2 * sub_n);
+            const Vec b = (live > 1) ? B::load(f + j + sub_n) : B::zero();
+            const Vec c = (live > 2) ? B::load(f + j + 2 * sub_n) : B::zero();
 
             const Vec s = m.add2(b, c);
             const Vec d = m.sub2(b, c);
@@ -72,9 +79,12 @@ struct Radix3Kernel {
     }
 
     // DIT pass: inverse of DIF, fuses 1/3 scale.
-    // Inputs in [0, M) (from inv_b2), outputs in [0, M) (with final shrink).
-    static void dit_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots) {
+    // Inputs in [0, 2M) (from a lazy inv_b2), outputs in [0, M) (with final shrink).
+    // Output rows live..2 are not needed and are left unwritten.
+    static void dit_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 3) {
         const idt sub_n = n / 3;
+        if (j_end > sub_n) j_end = sub_n;
         const int k = ntt_ctzll(sub_n);
 
         const Vec neg_half_v = B::broadcast(roots.neg_half);
@@ -86,11 +96,14 @@ struct Radix3Kernel {
         const Vec tw_inv_root_v = B::broadcast(tw_inv_root_s);
         const Vec tw2_inv_root_v = B::broadcast(tw2_inv_root_s);
 
-        // Running twiddle*inv3 scalars: start at inv3 (j=0), multiply by tw_inv_root each step
-        Vec tw1_s = inv3_v;       // ω_N^{0} * inv3 = inv3
-        Vec tw2_s = inv3_v;       // ω_N^{0} * inv3 = inv3
+        // Running twiddle*inv3 scalars: start at ω_N^{-j_begin} * inv3,
+        // multiply by tw_inv_root each step
+        Vec tw1_s = B::broadcast(ms.mul_s(roots.inv3,
+            ms.power_s(tw_inv_root_s, u32(j_begin), ms.one)));
+        Vec tw2_s = B::broadcast(ms.mul_s(roots.inv3,
+            ms.power_s(tw2_inv_root_s, u32(j_begin), ms.one)));
 
-        for (idt j = 0; j < sub_n; ++j) {
+        for (idt j = j_begin; j < j_end; ++j) {
             Vec f0 = B::load(f + j);
             Vec f1 = B::load(f + j + sub_n);
             Vec f2 = B::load(f + j + 2 * sub_n);
@@ -109,8 +122,8 @@ struct Radix3Kernel {
             const Vec ahs = m.add2(f0, hs);
 
             B::store(f + j, m.shrink(m.add2(f0, s)));
-            B::store(f + j + sub_n, m.shrink(m.sub2(ahs, jd)));
-            B::store(f + j + 2 * sub_n, m.shrink(m.add2(ahs, jd)));
+            if (live > 1) B::store(f + j + sub_n, m.shrink(m.sub2(ahs, jd)));
+            if (live > 2) B::store(f + j + 2 * sub_n, m.shrink(m.add2(ahs, jd)));
 
             // Update fused twiddle scalars
             tw1_s = m.mont_mul_bsm(tw1_s, tw_inv_root_v);
@@ -11,15 +11,16 @@ struct Radix4Kernel {
 
     // DIF: pure butterfly (r=0 path, no twiddle)
     // Inputs in [0, 2M), outputs: p0 [0,2M), p1/p2/p3 [0,4M)
+    // Inputs p_live..p3 are known zero (and need not be initialized).
     NTT_FORCEINLINE static void dif_butterfly_notw(
         Vec* p0, Vec* p1, Vec* p2, Vec* p3,
-        idt L, const M& m)
+        idt L, const M& m, int live = 4)
     {
         for (idt i = 0; i < L; ++i) {
             const Vec f0 = B::load(p0 + i);
-            const Vec f1 = B::load(p1 + i);
-            const Vec f2 = B::load(p2 + i);
-            const Vec f3 = B::load(p3 + i);
+            const Vec f1 = (live > 1) ? B::load(p1 + i) : B::zero();
+            const Vec f2 = (live > 2) ? B::load(p2 + i) : B::zero();
+            const Vec f3 = (live > 3) ? B::load(p3 + i) : B::zero();
 
             const Vec g1 = m.add2(f1, f3);
             const Vec g3 = m.mul_by_img(m.lazy_sub(f1, f3));
@@ -16,8 +16,14 @@ struct Radix5Kernel {
 
     // DIF pass: split n vecs into 5 sub-arrays of sub_n = n/5.
     // Inputs in [0, 2M), outputs in [0, 2M).
-    static void dif_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots) {
+    // [j_begin, j_end) restricts the pass to a slice of the sub_n columns
+    // (columns are independent; used to split the pass across threads).
+    // Input rows live..4 of those columns are known zero (need not be
+    // initialized).
+    static void dif_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 5) {
         const idt sub_n = n / 5;
+        if (j_end > sub_n) j_end = sub_n;
         const int k = ntt_ctzll(sub_n);
 
         const Vec c1h_v = B::broadcast(roots.c1h);
@@ -39,12 +45,12 @@ struct Radix5Kernel {
         const Vec tw4_root_v = B::broadcast(tw4_s);
 
         // j = 0: no twiddle
-        {
+        if (j_begin == 0 && j_end > 0) {
             const Vec a = B::load(f);
-            const Vec b = B::load(f + sub_n);
-            const Vec c = B::load(f + 2 * sub_n);
-            const Vec d = B::load(f + 3 * sub_n);
-            const Vec e = B::load(f + 4 * sub_n);
+            const Vec b = (live > 1) ? B::load(f + sub_n) : B::zero();
+            const Vec c = (live > 2) ? B::load(f + 2 * sub_n) : B::zero();
+            const Vec d = (live > 3) ? B::load(f + 3 * sub_n) : B::zero();
+            const Vec e = (live > 4) ? B::load(f + 4 * sub_n) : B::zero();
 
             const Vec s1 = m.add2(b, e);
             const Vec t1 = m.sub2(b, e);
@@ -80,16 +86,17 @@ struct Radix5Kernel {
         }
 
         // j > 0: with twiddles
-        Vec tw1 = B::broadcast(tw_root_s);
-        Vec tw2 = B::broadcast(tw2_s);
-        Vec tw3 = B::broadcast(tw3_s);
-        Vec tw4 = B::broadcast(tw4_s);
-        for (idt j = 1; j < sub_n; ++j) {
+        const idt j0 = (j_begin > 1) ? j_begin : 1;
+        Vec tw1 = B::broadcast(ms.power_s(tw_root_s, u32(j0), ms.one));
+        Vec tw2 = B::broadcast(ms.power_s(tw2_s, u32(j0), ms.one));
+        Vec tw3 = B::broadcast(ms.power_s(tw3_s, u32(j0), ms.one));
+        Vec tw4 = B::broadcast(ms.power_s(tw4_s, u32(j0), ms.one));
+        for (idt j = j0; j < j_end; ++j) {
             const Vec a = B::load(f + j);
-            const Vec b = B::load(f + j + sub_n);
-            const Vec c = B::load(f + j + 2 * sub_n);
-            const Vec d = B::load(f + j + 3 * sub_n);
-            const Vec e = B::load(f + j + 4 * sub_n);
+            const Vec b = (live > 1) ? B::load(f + j + sub_n) : B::zero();
+            const Vec c = (live > 2) ? B::load(f + j + 2 * sub_n) : B::zero();
+            const Vec d = (live > 3) ? B::load(f + j + 3 * sub_n) : B::zero();
+            const Vec e = (live > 4) ? B::load(f + j + 4 * sub_n) : B::zero();
 
             const Vec s1 = m.add2(b, e);
             const Vec t1 = m.sub2(b, e);
@@ -125,9 +132,12 @@ struct Radix5Kernel {
     }
 
     // DIT pass: inverse of DIF, fuses 1/5 scale.
-    // Inputs in [0, M) (from inv_b2), outputs in [0, M) (with final shrink).
-    static void dit_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots) {
+    // Inputs in [0, 2M) (from a lazy inv_b2), outputs in [0, M) (with final shrink).
+    // Output rows live..4 are not needed and are left unwritten.
+    static void dit_pass(Vec* f, idt n, const MV& m, const RootPlan<Mod>& roots,
+                         idt j_begin = 0, idt j_end = ~idt(0), int live = 5) {
         const idt sub_n = n / 5;
+        if (j_end > sub_n) j_end = sub_n;
         const int k = ntt_ctzll(sub_n);
 
         const Vec c1h_v = B::broadcast(roots.c1h);
@@ -147,13 +157,14 @@ struct Radix5Kernel {
         const Vec tw3i_root_v = B::broadcast(tw3i_s);
         const Vec tw4i_root_v = B::broadcast(tw4i_s);
 
-        // Fused twiddle*inv5 running scalars
-        Vec tws1 = inv5_v;
-        Vec tws2 = inv5_v;
-        Vec tws3 = inv5_v;
-        Vec tws4 = inv5_v;
+        // Fused twiddle*inv5 running scalars, starting at ω^{-j_begin} * inv5
+        const u32 jb = u32(j_begin);
+        Vec tws1 = B::broadcast(ms.mul_s(roots.inv5, ms.power_s(tw_inv_root_s, jb, ms.one)));
+        Vec tws2 = B::broadcast(ms.mul_s(roots.inv5, ms.power_s(tw2i_s, jb, ms.one)));
+        Vec tws3 = B::broadcast(ms.mul_s(roots.inv5, ms.power_s(tw3i_s, jb, ms.one)));
+        Vec tws4 = B::broadcast(ms.mul_s(roots.inv5, ms.power_s(tw4i_s, jb, ms.one)));
 
-        for (idt j = 0; j < sub_n; ++j) {
+        for (idt j = j_begin; j < j_end; ++j) {
             Vec fa = B::load(f + j);
             Vec fb = B::load(f + j + sub_n);
             Vec fc = B::load(f + j + 2 * sub_n);
@@ -193,10 +204,10 @@ struct Radix5Kernel {
 
             // Signs flipped vs DIF for outputs 1↔4 and 2↔3
             B::store(f + j, m.shrink(f0));
-            B::store(f + j + sub_n, m.shrink(m.sub2(alpha, beta)));
-            B::store(f + j + 2 * sub_n, m.shrink(m.sub2(gamma, delta)));
-            B::store(f + j + 3 * sub_n, m.shrink(m.add2(gamma, delta)));
-            B::store(f + j + 4 * sub_n, m.shrink(m.add2(alpha, beta)));
+            if (live > 1) B::store(f + j + sub_n, m.shrink(m.sub2(alpha, beta)));
+            if (live > 2) B::store(f + j + 2 * sub_n, m.shrink(m.sub2(gamma, delta)));
+            if (live > 3) B::store(f + j + 3 * sub_n, m.shrink(m.add2(gamma, delta)));
+            if (live > 4) B::store(f + j + 4 * sub_n, m.shrink(m.add2(alpha, beta)));
 
             // Update fused twiddle scalars
             tws1 = m.mont_mul_bsm(tws1, tw_inv_root_v);
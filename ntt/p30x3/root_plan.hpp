@@ -55,6 +55,10 @@ struct RootPlan {
     u32 tw3i_root[MAX_LG + 1];
     u32 tw5_root[MAX_LG + 1];
     u32 tw5i_root[MAX_LG + 1];
+    // tw15_root[k] = ω_{15*2^k} for the radix-15 pass (zero unless 15
+    // divides Mod - 1)
+    u32 tw15_root[MAX_LG + 1];
+    u32 tw15i_root[MAX_LG + 1];
 
     // Power-of-2 roots in Montgomery form:
     // pow2_root[t]  = omega_{2^t}, pow2i_root[t] = omega_{2^t}^{-1}
@@ -69,7 +73,7 @@ struct RootPlan {
         rt4nr{}, rt4nr2{}, rt4nri{}, rt4nr2i{},
         neg_half(0), j3_half(0), inv3(0), inv5(0),
         c1h(0), c2h(0), j1h(0), j2h(0),
-        tw3_root{}, tw3i_root{}, tw5_root{}, tw5i_root{},
+        tw3_root{}, tw3i_root{}, tw5_root{}, tw5i_root{}, tw15_root{}, tw15i_root{},
         pow2_root{}, pow2i_root{}
     {
         const int k = ctz_constexpr(Mod - 1);
@@ -258,6 +262,16 @@ struct RootPlan {
             tw5i_root[k] = ms.power_s(tw5_root[k], Mod - 2, ms.one);
             for (int j = k; j > 0; --j)
                 tw5i_root[j - 1] = ms.mul_s(tw5i_root[j], tw5i_root[j]);
+
+            if ((Mod - 1) % 15 == 0) {
+                tw15_root[k] = ms.power_s(g_full, (Mod - 1) / (u32(15) << k), ms.one);
+                for (int j = k; j > 0; --j)
+                    tw15_root[j - 1] = ms.mul_s(tw15_root[j], tw15_root[j]);
+
+                tw15i_root[k] = ms.power_s(tw15_root[k], Mod - 2, ms.one);
+                for (int j = k; j > 0; --j)
+                    tw15i_root[j - 1] = ms.mul_s(tw15i_root[j], tw15i_root[j]);
+            }
         }
     }
 
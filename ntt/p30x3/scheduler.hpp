@@ -6,12 +6,27 @@
 #include "radix2.hpp"
 #include "radix3.hpp"
 #include "radix5.hpp"
+#include "radix15.hpp"
 #include "cyclic_conv.hpp"
+#include "../thread_pool.hpp"
 #include <array>
 #include <algorithm>
+#include <cstring>
+#include <utility>
 
 namespace ntt {
 
+// Outputs a truncated transform of n Vecs (power of 2) keeps for a product
+// of `vecs` Vecs: vecs rounded up to the grain of NTTScheduler::inverse_tft,
+// n/64 Vecs but at least 16.  Past 7n/8 it is n: the truncated inverse
+// costs about one radix-2 pass more than the full one, which the few
+// skipped outputs no longer repay.
+inline idt tft_length(idt n, idt vecs) {
+    const idt g = (std::max)(idt(16), n >> 6);
+    const idt need = cdiv(vecs, g) * g;
+    return (need > n - (n >> 3)) ? n : need;
+}
+
 // NTTScheduler: cache-oblivious NTT engine.
 // Implements j-based traversal with ruler-sequence root updates.
 // Direct structural port of __vec_dif / __vec_dit / __vec_cvdt8 from ref.cpp.
@@ -29,45 +44,56 @@ struct NTTScheduler {
         return ms;
     }
 
-    // Base-2 forward NTT (DIF), power-of-2 sizes only.
-    static void fwd_b2(Vec* f, idt n) {
-        const auto& roots = get_roots();
-        const auto& ms = get_ms();
-
-        alignas(32) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
-        // View as array of 8-u32 blocks
-        auto st_1 = [&](int idx) -> u32* { return st_1_raw + idx * B::LANES; };
-
-        const MontVec<B> m(ms.mod, ms.niv, roots.img);
-        const Vec Niv = B::broadcast(ms.niv);
-        const Vec id24 = B::setr(0, 2, 0, 4, 0, 2, 0, 4);
-
-        const int lgn = ntt_ctzll(n);
+    // Transforms below this many Vecs are never split across threads.
+    static constexpr idt PARALLEL_MIN_VECS = idt(1) << 12;
 
-        // Fill ruler sequence state with initial root state
-        for (int i = 0; i < (lgn >> 1); ++i) {
-            for (int j = 0; j < B::LANES; ++j)
-                st_1(i)[j] = roots.bwb[j];
+    // Advance a ruler-sequence root state: multiply lanes 0/2/4 of st by
+    // prod_{s0 <= s < s1} jump[ctz(~s)][lane+1].  Lets a traversal start at
+    // an arbitrary group index without replaying the sequence; the result is
+    // the same canonical [0, M) residue the sequential updates produce.
+    // Backends wider than 8 lanes hold the state repeated per 8 lanes.
+    static void ruler_jump(u32* st, const u32 (*jump)[8], idt s0, idt s1) {
+        const auto& ms = get_ms();
+        for (int i = 0; (idt(1) << i) <= s1; ++i) {
+            // #{s < x : s mod 2^(i+1) == 2^i - 1} = (x + 2^i) >> (i+1)
+            const idt h = idt(1) << i;
+            const idt c = ((s1 + h) >> (i + 1)) - ((s0 + h) >> (i + 1));
+            if (!c) continue;
+            for (int lane = 0; lane < 6; lane += 2)
+                st[lane] = ms.mul_s(st[lane],
+                    ms.power_s(jump[i][lane + 1], u32(c), ms.one));
         }
+        for (int j = 8; j < B::LANES; ++j) st[j] = st[j - 8];
+    }
 
-        const idt nn = n >> (lgn & 1);
-        const idt blk = (std::min)(n, BLOCK_SIZE);
-
-        // Phase 1: Optional radix-2 pass for odd lgn
-        if (nn != n) {
-            Radix2Kernel<B>::dif_pass(f, nn, m);
+    // Twisted-conv root for batch b (Vecs [4b, 4b+4)) of a chain started
+    // at rr: rr * prod_{1 <= u <= b} RT3[2 + ctz(u)].
+    static u32 conv_root_jump(u32 rr, idt b) {
+        const auto& roots = get_roots();
+        const auto& ms = get_ms();
+        for (int i = 0; (idt(1) << i) <= b; ++i) {
+            const idt c = (b >> i) - (b >> (i + 1));
+            if (c) rr = ms.mul_s(rr, ms.power_s(roots.RT3[i + 2], u32(c), ms.one));
         }
+        return rr;
+    }
 
-        // Phase 2: Pure butterfly chain (r=0 path, no twiddle)
-        for (idt L = nn >> 2; L > 0; L >>= 2) {
-            Radix4Kernel<B>::dif_butterfly_notw(f, f + L, f + 2 * L, f + 3 * L, L, m);
-        }
+    // Phase 3 of fwd_b2 over the j-blocks in [j_lo, j_hi).  The first block
+    // starts at level 2^t_first; later ones at 2^min(ctz(j), t_cap).
+    // st_1_raw holds the ruler state of every level at entry.
+    static void dif_blocks(Vec* f, idt j_lo, idt j_hi, idt blk,
+                           int t_first, int t_cap, u32* st_1_raw,
+                           const MontVec<B>& m) {
+        const auto& roots = get_roots();
+        auto st_1 = [&](int idx) -> u32* { return st_1_raw + idx * B::LANES; };
+        const Vec Niv = B::broadcast(get_ms().niv);
+        const Vec id24 = B::setr(0, 2, 0, 4, 0, 2, 0, 4);
 
-        // Phase 3: j-based cache-oblivious blocked traversal
-        int t = (std::min)((int)LOG_BLOCK, lgn) & ~1;
+        int t = t_first;
         int p = (t - 2) >> 1;
 
-        for (idt j = 0; j < n; j += blk, t = ntt_ctzll(j) & ~1, p = (t - 2) >> 1) {
+        for (idt j = j_lo; j < j_hi; j += blk,
+             t = (std::min)(ntt_ctzll(j), t_cap) & ~1, p = (t - 2) >> 1) {
             Vec* const g = f + j;
 
             for (idt l = (idt(1) << t), L = l >> 2; L; l = L, L >>= 2, t -= 2, --p) {
@@ -78,7 +104,7 @@ struct NTTScheduler {
                     Vec r1 = B::permutevar(rt, id24);
                     Vec r1_niv = B::permutevar(B::mul64(rt, Niv), id24);
                     rt = m.mul_upd_root(rt,
-                        B::load(roots.rt3[ntt_ctzll(~(unsigned)k)]));
+                        B::load8(roots.rt3[ntt_ctzll(~(unsigned)k)]));
 
                     Vec r2 = B::shuffle_BBBB(r1);
                     Vec nr3 = B::shuffle_DDDD(r1);
@@ -95,38 +121,22 @@ struct NTTScheduler {
         }
     }
 
-    // Base-2 inverse NTT (DIT), power-of-2 sizes only.
-    static void inv_b2(Vec* f, idt n) {
+    // DIT counterpart of dif_blocks: j-blocks in [j_lo, j_hi), outer layers
+    // capped at 2^t_cap.  st_1(0) carries the scale-fused innermost chain.
+    static void dit_blocks(Vec* f, idt n, idt j_lo, idt j_hi, idt blk,
+                           int t_cap, u32* st_1_raw, const MontVec<B>& m) {
         const auto& roots = get_roots();
         const auto& ms = get_ms();
-
-        alignas(32) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
         auto st_1 = [&](int idx) -> u32* { return st_1_raw + idx * B::LANES; };
-
-        const MontVec<B> m(ms.mod, ms.niv, roots.img);
         const Vec Niv = B::broadcast(ms.niv);
         const Vec id24 = B::setr(0, 2, 0, 4, 0, 2, 0, 4);
 
-        const int lgn = ntt_ctzll(n);
-
-        // Fill inverse root state (skip index 0, it gets scale factor)
-        for (int i = 1; i < (lgn >> 1); ++i) {
-            for (int j = 0; j < B::LANES; ++j)
-                st_1(i)[j] = roots.bwbi[j];
-        }
-
-        const idt nn = n >> (lgn & 1);
-        const idt blk = (std::min)(n, BLOCK_SIZE);
-
-        // Compute N^{-1} scale factor
         const u32 fx = roots.compute_scale(n);
         const Vec Fx = B::broadcast(fx);
         const Vec FxNiv = B::broadcast(fx * ms.niv);
-        B::store(st_1(0), Fx);
 
-        // j-based blocked traversal (DIT)
-        for (idt j = 0; j < n; j += blk) {
-            int tt = ntt_ctzll(j + blk);
+        for (idt j = j_lo; j < j_hi; j += blk) {
+            int tt = (std::min)(ntt_ctzll(j + blk), t_cap);
             int t = 4, p = 1;
 
             // Innermost layer (L=1): scale fusion
@@ -135,7 +145,7 @@ struct NTTScheduler {
                 for (idt i = j; i < j + blk; i += 4) {
                     Vec r1 = B::permutevar(rt, id24);
                     rt = m.mul_upd_root(rt,
-                        B::load(roots.rt3i[ntt_ctzll(~(unsigned)(i >> 2))]));
+                        B::load8(roots.rt3i[ntt_ctzll(~(unsigned)(i >> 2))]));
 
                     Vec r2 = B::shuffle_BBBB(r1);
                     Vec r3 = B::shuffle_DDDD(r1);
@@ -165,7 +175,7 @@ struct NTTScheduler {
                     Vec r1 = B::permutevar(rt, id24);
                     Vec r1_niv = B::permutevar(B::mul64(rt, Niv), id24);
                     rt = m.mul_upd_root(rt,
-                        B::load(roots.rt3i[ntt_ctzll(~(unsigned)k)]));
+                        B::load8(roots.rt3i[ntt_ctzll(~(unsigned)k)]));
 
                     Vec r2 = B::shuffle_BBBB(r1);
                     Vec r3 = B::shuffle_DDDD(r1);
@@ -180,87 +190,532 @@ struct NTTScheduler {
                 B::store(st_1(p), rt);
             }
         }
+    }
+
+    // Chunk size for a threaded base-2 transform: the largest power of 4
+    // (>= BLOCK_SIZE, <= nn) that still yields >= 4 chunks per thread.
+    static int parallel_chunk_log(int lgn, unsigned threads) {
+        int ls = lgn & ~1;
+        while (ls - 2 >= LOG_BLOCK && (idt(1) << (lgn - ls)) < idt(4) * threads)
+            ls -= 2;
+        return ls;
+    }
+
+    // One radix-4 level (span l = 4L) applied to every group, split into
+    // tasks of contiguous butterfly rows.  Group 0 has no twiddle.
+    static void parallel_level(Vec* f, idt n, idt l, unsigned threads,
+                               bool inverse, const MontVec<B>& m) {
+        const auto& roots = get_roots();
+        const Vec Niv = B::broadcast(get_ms().niv);
+        const Vec id24 = B::setr(0, 2, 0, 4, 0, 2, 0, 4);
+        const idt L = l >> 2;
+        const idt groups = n / l;
+        idt per = (idt(4) * threads + groups - 1) / groups;
+        if (per > L) per = L;
+
+        ThreadPool::instance().parallel_for(groups * per, threads, [&](idt task) {
+            const idt k = task / per, s = task % per;
+            const idt lo = L * s / per, hi = L * (s + 1) / per;
+            Vec* const g = f + k * l + lo;
+            const idt len = hi - lo;
+            if (k == 0) {
+                if (inverse)
+                    Radix4Kernel<B>::dit_butterfly_notw(
+                        g, g + L, g + 2 * L, g + 3 * L, len, m, l == n);
+                else
+                    Radix4Kernel<B>::dif_butterfly_notw(
+                        g, g + L, g + 2 * L, g + 3 * L, len, m);
+                return;
+            }
+            alignas(B::ALIGN) u32 st[B::LANES];
+            for (int j = 0; j < B::LANES; ++j)
+                st[j] = inverse ? roots.bwbi[j & 7] : roots.bwb[j & 7];
+            ruler_jump(st, inverse ? roots.rt3i : roots.rt3, 1, k);
+
+            const Vec rt = B::load(st);
+            const Vec r1 = B::permutevar(rt, id24);
+            const Vec r1_niv = B::permutevar(B::mul64(rt, Niv), id24);
+            const Vec r2 = B::shuffle_BBBB(r1);
+            const Vec r3 = B::shuffle_DDDD(r1);
+            const Vec r2_niv = B::shuffle_BBBB(r1_niv);
+            const Vec r3_niv = B::shuffle_DDDD(r1_niv);
+            if (inverse)
+                Radix4Kernel<B>::dit_butterfly(
+                    g, g + L, g + 2 * L, g + 3 * L,
+                    len, r1, r1_niv, r2, r2_niv, r3, r3_niv, m);
+            else
+                Radix4Kernel<B>::dif_butterfly(
+                    g, g + L, g + 2 * L, g + 3 * L,
+                    len, r1, r1_niv, r2, r2_niv, r3, r3_niv, m);
+        });
+    }
+
+    // ── Pruning (known-zero input tail / truncated output) ──
+
+    // Split columns [lo, hi) of a pass with `rows` rows of `stride` Vecs into
+    // runs where the number of live rows is constant (row q of column i is
+    // live iff i + q*stride < len) and call body(run_lo, run_hi, live).
+    template<typename F>
+    static void for_live_runs(idt lo, idt hi, idt stride, int rows, idt len, F&& body) {
+        while (lo < hi) {
+            int live = 0;
+            idt end = hi;
+            if (lo < len) {
+                const idt c = (len - lo + stride - 1) / stride;
+                live = (c < idt(rows)) ? int(c) : rows;
+                end = (std::min)(hi, len - (live - 1) * stride);
+            }
+            body(lo, end, live);
+            lo = end;
+        }
+    }
+
+    // Zero columns [lo, hi) of all `rows` rows.
+    static void zero_rows(Vec* f, idt lo, idt hi, idt stride, int rows) {
+        for (int q = 0; q < rows; ++q)
+            std::memset((void*)(f + q * stride + lo), 0, (hi - lo) * sizeof(Vec));
+    }
+
+    // Top stage of fwd_b2 (the radix-2 pass for odd lgn, else the first
+    // radix-4 level) over columns [lo, hi), reading f[len..n) as zero.
+    static void dif_top(Vec* f, idt n, idt len, idt lo, idt hi, const MontVec<B>& m) {
+        const idt nn = n >> (ntt_ctzll(n) & 1);
+        const idt stride = (nn != n) ? nn : (n >> 2);
+        const int rows = (nn != n) ? 2 : 4;
+        for_live_runs(lo, hi, stride, rows, len, [&](idt a, idt b, int live) {
+            if (live == 0)
+                zero_rows(f, a, b, stride, rows);
+            else if (rows == 2)
+                Radix2Kernel<B>::dif_butterfly(f + a, f + stride + a, b - a, m, live);
+            else
+                Radix4Kernel<B>::dif_butterfly_notw(
+                    f + a, f + stride + a, f + 2 * stride + a, f + 3 * stride + a,
+                    b - a, m, live);
+        });
+    }
+
+    // Radix-2 pass of inv_b2 (odd lgn) over columns [lo, hi), producing
+    // only f[0..len).
+    static void dit_top(Vec* f, idt nn, idt len, idt lo, idt hi, const MontVec<B>& m) {
+        for_live_runs(lo, hi, nn, 2, len, [&](idt a, idt b, int live) {
+            if (live) Radix2Kernel<B>::dit_butterfly(f + a, f + nn + a, b - a, m, live);
+        });
+    }
+
+    // Base-2 forward NTT (DIF), power-of-2 sizes only.
+    // threads > 1 splits large transforms: the top levels run level by
+    // level over all threads, then independent chunks of 4^q Vecs each run
+    // the blocked traversal from a jumped ruler state.
+    // f[len..n) is read as zero and need not be initialized.
+    // Truncated mode (single thread): only the blocks holding f[0..need)
+    // are transformed; the rest is left unspecified.
+    static void fwd_b2(Vec* f, idt n, unsigned threads = 1, idt len = ~idt(0),
+                       idt need = ~idt(0)) {
+        const auto& roots = get_roots();
+        const auto& ms = get_ms();
+        const MontVec<B> m(ms.mod, ms.niv, roots.img);
+
+        const int lgn = ntt_ctzll(n);
+        const idt nn = n >> (lgn & 1);
+        const idt blk = (std::min)(n, BLOCK_SIZE);
+        // Vecs covered by the top stage (pruned by dif_top): the radix-2
+        // pass for odd lgn, else the first radix-4 level
+        const idt top = (nn != n) ? nn : (n >> 2);
+        if (len > n) len = n;
+
+        if (threads > 1 && n >= PARALLEL_MIN_VECS) {
+            const int ls = parallel_chunk_log(lgn, threads);
+            const idt S = idt(1) << ls;
+
+            // Phase 1: top stage, split by rows
+            parallel_for_rows(top, threads, [&](idt lo, idt hi) {
+                dif_top(f, n, len, lo, hi, m);
+            });
+            // Phase 2: levels above the chunk size
+            for (idt l = (nn != n) ? nn : (nn >> 2); l > S; l >>= 2)
+                parallel_level(f, n, l, threads, false, m);
+
+            // Phase 3: chunks below
+            ThreadPool::instance().parallel_for(n >> ls, threads, [&](idt c) {
+                alignas(B::ALIGN) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
+                for (int p = 0; p < (ls >> 1); ++p) {
+                    u32* st = st_1_raw + p * B::LANES;
+                    for (int j = 0; j < B::LANES; ++j) st[j] = roots.bwb[j & 7];
+                    const idt k0 = (c << ls) >> (2 * p + 2);
+                    ruler_jump(st, roots.rt3, 1, (std::max)(k0, idt(1)));
+                }
+                if (c == 0) {
+                    for (idt L = S >> 2; L > 0; L >>= 2)
+                        Radix4Kernel<B>::dif_butterfly_notw(
+                            f, f + L, f + 2 * L, f + 3 * L, L, m);
+                }
+                dif_blocks(f, c << ls, (c + 1) << ls, blk, ls, ls, st_1_raw, m);
+            });
+            return;
+        }
+
+        alignas(B::ALIGN) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
+
+        // Fill ruler sequence state with initial root state
+        for (int i = 0; i < (lgn >> 1); ++i) {
+            for (int j = 0; j < B::LANES; ++j)
+                st_1_raw[i * B::LANES + j] = roots.bwb[j & 7];
+        }
+
+        // Phase 1: top stage (radix-2 pass for odd lgn, else the first
+        // radix-4 level), skipping the zero tail
+        dif_top(f, n, len, 0, top, m);
+
+        // Phase 2: Pure butterfly chain (r=0 path, no twiddle)
+        for (idt L = ((nn != n) ? nn : top) >> 2; L > 0; L >>= 2) {
+            Radix4Kernel<B>::dif_butterfly_notw(f, f + L, f + 2 * L, f + 3 * L, L, m);
+        }
+
+        // Phase 3: j-based cache-oblivious blocked traversal.  Blocks are
+        // finished in order, so stopping early leaves an exact prefix.
+        const idt j_end = (need < n) ? cdiv(need, blk) * blk : n;
+        dif_blocks(f, 0, j_end, blk, (std::min)((int)LOG_BLOCK, lgn) & ~1, lgn,
+                   st_1_raw, m);
+    }
+
+    // Base-2 inverse NTT (DIT), power-of-2 sizes only.
+    // threads > 1 mirrors fwd_b2: chunks first, then the top levels.
+    // Only f[0..len) is produced; the rest is left unspecified.
+    // Outputs are in [0, M), or in [0, 2M) when lazy: the final reduction
+    // pass is then left to the consumer (the CRT folds it into its loads).
+    static void inv_b2(Vec* f, idt n, unsigned threads = 1, idt len = ~idt(0),
+                       bool lazy = false) {
+        const auto& roots = get_roots();
+        const auto& ms = get_ms();
+        const MontVec<B> m(ms.mod, ms.niv, roots.img);
+
+        const int lgn = ntt_ctzll(n);
+        const idt nn = n >> (lgn & 1);
+        const idt blk = (std::min)(n, BLOCK_SIZE);
+        const Vec vMod = B::broadcast(ms.mod);
+        if (len > n) len = n;
+
+        if (threads > 1 && n >= PARALLEL_MIN_VECS) {
+            const int ls = parallel_chunk_log(lgn, threads);
+            const idt S = idt(1) << ls;
+            const u32 fx = roots.compute_scale(n);
+
+            ThreadPool::instance().parallel_for(n >> ls, threads, [&](idt c) {
+                alignas(B::ALIGN) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
+                // Level 0: scale-fused chain, counted from group 0
+                for (int j = 0; j < B::LANES; ++j) st_1_raw[j] = fx;
+                ruler_jump(st_1_raw, roots.rt3i, 0, (c << ls) >> 2);
+                for (int p = 1; p < (ls >> 1); ++p) {
+                    u32* st = st_1_raw + p * B::LANES;
+                    for (int j = 0; j < B::LANES; ++j) st[j] = roots.bwbi[j & 7];
+                    const idt k0 = (c << ls) >> (2 * p + 2);
+                    ruler_jump(st, roots.rt3i, 1, (std::max)(k0, idt(1)));
+                }
+                dit_blocks(f, n, c << ls, (c + 1) << ls, blk, ls, st_1_raw, m);
+            });
+            for (idt l = S << 2; l <= nn; l <<= 2)
+                parallel_level(f, n, l, threads, true, m);
+
+            if (nn != n) {
+                // Radix-2 pass (shrinks to [0, M) itself)
+                parallel_for_rows((std::min)(nn, len), threads, [&](idt lo, idt hi) {
+                    dit_top(f, nn, len, lo, hi, m);
+                });
+            } else if (!lazy) {
+                parallel_for_rows(len, threads, [&](idt lo, idt hi) {
+                    for (idt i = lo; i < hi; ++i) {
+                        Vec v = B::load(f + i);
+                        B::store(f + i, B::min32(v, B::sub32(v, vMod)));
+                    }
+                });
+            }
+            return;
+        }
+
+        alignas(B::ALIGN) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
 
-        // Optional radix-2 pass for odd lgn
+        // Fill inverse root state (skip index 0, it gets scale factor)
+        for (int i = 1; i < (lgn >> 1); ++i) {
+            for (int j = 0; j < B::LANES; ++j)
+                st_1_raw[i * B::LANES + j] = roots.bwbi[j & 7];
+        }
+
+        // Compute N^{-1} scale factor
+        B::store((Vec*)st_1_raw, B::broadcast(roots.compute_scale(n)));
+
+        // j-based blocked traversal (DIT)
+        dit_blocks(f, n, 0, n, blk, lgn, st_1_raw, m);
+
+        // Optional radix-2 pass for odd lgn (shrinks to [0, M) itself)
         if (nn != n) {
-            Radix2Kernel<B>::dit_pass(f, nn, m);
+            dit_top(f, nn, len, 0, (std::min)(nn, len), m);
+        } else if (!lazy) {
+            // Final reduction: the radix-4 levels leave values in [0, 2M)
+            for (idt i = 0; i < len; ++i) {
+                Vec v = B::load(f + i);
+                B::store(f + i, B::min32(v, B::sub32(v, vMod)));
+            }
+        }
+    }
+
+    // ── Truncated inverse (power-of-2 sizes) ──
+    //
+    // The DIF is a binary remainder tree: node [o, o+l) holds the product
+    // mod y^l - c (y = x^LANES), its halves hold it mod y^(l/2) -+ d with
+    // d = rho(o)^(l/2), rho(o) the twisted_conv root of the leaf at Vec o.
+    // inverse_tft (van der Hoeven's inverse TFT) recovers the first `need`
+    // coefficients from the first `need` leaves when the rest are zero.
+    // Nodes whose leaves are all known are inverted in full by dit_blocks;
+    // each level of the boundary path between known and unknown leaves
+    // costs one radix-2 pass over part of the node.
+
+    // Broadcast Montgomery constant (k, k*niv) for mont_mul_precomp.
+    static std::pair<Vec, Vec> bcast(u32 k) {
+        return {B::broadcast(k), B::broadcast(k * get_ms().niv)};
+    }
+
+    // d for the halves of the node of span 2h at Vec o.
+    static u32 node_root(idt o, idt h) {
+        const auto& ms = get_ms();
+        return ms.power_s(conv_root_jump(ms.one, o >> 2), u32(h), ms.one);
+    }
+
+    // Full inverse of the node [o, o+s), s = 4^q >= 4: the chunk traversal
+    // of the threaded inv_b2 with a 1/s scale.  Outputs in [0, 2M).
+    static void inv_node4(Vec* f, idt o, idt s, const MontVec<B>& m) {
+        const auto& roots = get_roots();
+        const int ls = ntt_ctzll(s);
+        alignas(B::ALIGN) u32 st_1_raw[(MAX_LOG >> 1) * B::LANES];
+        for (int j = 0; j < B::LANES; ++j) st_1_raw[j] = roots.compute_scale(s);
+        ruler_jump(st_1_raw, roots.rt3i, 0, o >> 2);
+        for (int p = 1; p < (ls >> 1); ++p) {
+            u32* st = st_1_raw + p * B::LANES;
+            for (int j = 0; j < B::LANES; ++j) st[j] = roots.bwbi[j & 7];
+            ruler_jump(st, roots.rt3i, 1, (std::max)(o >> (2 * p + 2), idt(1)));
         }
+        dit_blocks(f, s, o, o + s, (std::min)(s, BLOCK_SIZE), ls, st_1_raw, m);
+    }
+
+    // Children of the node [o, o+2h) back to its coefficients.
+    static void tft_merge(Vec* f, idt o, idt h, idt len, u32 d, const MontVec<B>& m) {
+        const auto& ms = get_ms();
+        const u32 half = ms.mul_s((Mod + 1) >> 1, ms.r2);
+        const auto hv = bcast(half);
+        const auto kv = bcast(ms.mul_s(half, ms.power_s(d, Mod - 2, ms.one)));
+        Radix2Kernel<B>::tft_merge(f + o, f + o + h, len,
+                                   hv.first, hv.second, kv.first, kv.second, m);
+    }
+
+    // Full inverse of the node [o, o+s), s a power of 2 >= 8.
+    static void inv_node(Vec* f, idt o, idt s, const MontVec<B>& m) {
+        if (!(ntt_ctzll(s) & 1)) { inv_node4(f, o, s, m); return; }
+        const idt h = s >> 1;
+        inv_node4(f, o, h, m);
+        inv_node4(f, o + h, h, m);
+        tft_merge(f, o, h, h, node_root(o, h), m);
+    }
+
+    // Node [o, o+l) holds leaf values below k and its own coefficients from
+    // k up; afterwards it holds its coefficients below k (those from k up
+    // are clobbered).  k is a multiple of the grain.
+    static void itft_node(Vec* f, idt o, idt l, idt k, const MontVec<B>& m) {
+        if (k == 0) return;
+        if (k == l) { inv_node(f, o, l, m); return; }
+        const auto& ms = get_ms();
+        const idt h = l >> 1;
+        const u32 d = node_root(o, h);
+        Vec* const p0 = f + o;
+        Vec* const p1 = f + o + h;
+        if (k >= h) {
+            // Child 0 is all leaves; with the known top coefficients it
+            // yields child-1 values for the leaves child 1 lacks.
+            inv_node(f, o, h, m);
+            const auto dv = bcast(d);
+            Radix2Kernel<B>::tft_split(p0 + (k - h), p1 + (k - h), l - k,
+                                       dv.first, dv.second, m);
+            itft_node(f, o + h, h, k - h, m);
+            tft_merge(f, o, h, k - h, d, m);
+        } else {
+            // Child-0 values for the leaves it lacks, then back down
+            const auto dv = bcast(d);
+            const auto nv = bcast(d ? Mod - d : 0);
+            Radix2Kernel<B>::tft_axpy(p0 + k, p1 + k, h - k, dv.first, dv.second, m);
+            itft_node(f, o, h, k, m);
+            Radix2Kernel<B>::tft_axpy(p0, p1, k, nv.first, nv.second, m);
+        }
+    }
 
-        // Final reduction: ensure all elements are in [0, M)
-        // The DIT may leave values in [0, 2M) when the outermost layer
-        // is the innermost (e.g., nvecs=4) or certain size configurations.
-        {
+    // Inverse of fwd_b2 truncated to f[0..need), need = tft_length(n, ...)
+    // covering the product.  Only f[0..need) is produced; outputs are in
+    // [0, M), or in [0, 2M) when lazy.  Single-threaded.
+    static void inverse_tft(Vec* f, idt n, idt need, bool lazy = false) {
+        const auto& roots = get_roots();
+        const auto& ms = get_ms();
+        const MontVec<B> m(ms.mod, ms.niv, roots.img);
+
+        // The top coefficients are zero: while the product fits in the
+        // lower half, child 0 (y^(n/2) - 1) holds it as is.
+        while (need <= (n >> 1)) n >>= 1;
+        if (need == n) {
+            inv_node(f, 0, n, m);
+        } else {
+            const idt h = n >> 1;
+            inv_node(f, 0, h, m);
+            // With hi = 0 the missing child-1 values equal child 0's
+            std::memcpy((void*)(f + need), (const void*)(f + need - h),
+                        (n - need) * sizeof(Vec));
+            itft_node(f, h, h, need - h, m);
+            tft_merge(f, 0, h, need - h, ms.one, m);
+        }
+        if (!lazy) {
             const Vec vMod = B::broadcast(ms.mod);
-            for (idt i = 0; i < n; ++i) {
+            for (idt i = 0; i < need; ++i) {
                 Vec v = B::load(f + i);
                 B::store(f + i, B::min32(v, B::sub32(v, vMod)));
             }
         }
     }
 
+    // Run body(lo, hi) over `threads` contiguous slices of [0, rows).
+    template<typename F>
+    static void parallel_for_rows(idt rows, unsigned threads, F&& body) {
+        const unsigned parts = (rows < threads) ? unsigned(rows) : threads;
+        ThreadPool::instance().parallel_for(parts, threads, [&](idt p) {
+            body(rows * p / parts, rows * (p + 1) / parts);
+        });
+    }
+
     // ── Mixed-radix dispatch ──
-    // n = m * 2^k where m ∈ {1, 3, 5}
+    // n = m * 2^k where m ∈ {1, 3, 5, 15}
+
+    // Outer radix-m DIF/DIT pass over columns [a, b) with `live` input
+    // (DIF) or output (DIT) rows
+    template<bool DIT>
+    static void outer_pass(Vec* f, idt n, idt m, const MontVec<B>& mv,
+                           const RootPlan<Mod>& roots, idt a, idt b, int live) {
+        if (m == 3) {
+            if (DIT) Radix3Kernel<B, Mod>::dit_pass(f, n, mv, roots, a, b, live);
+            else     Radix3Kernel<B, Mod>::dif_pass(f, n, mv, roots, a, b, live);
+        } else if (m == 5) {
+            if (DIT) Radix5Kernel<B, Mod>::dit_pass(f, n, mv, roots, a, b, live);
+            else     Radix5Kernel<B, Mod>::dif_pass(f, n, mv, roots, a, b, live);
+        } else {
+            if (DIT) Radix15Kernel<B, Mod>::dit_pass(f, n, mv, roots, a, b, live);
+            else     Radix15Kernel<B, Mod>::dif_pass(f, n, mv, roots, a, b, live);
+        }
+    }
 
     // Forward NTT (DIF): outer radix-m pass, then fwd_b2 on each sub-array.
-    static void forward(Vec* f, idt n) {
+    // threads > 1 splits the radix-m pass by columns and runs the m
+    // sub-transforms concurrently.
+    // Pruned mode: f[len..n) is read as zero and need not be initialized,
+    // so callers can skip zero-padding the input; the top stage skips the
+    // dead rows.  The output is the full transform either way, unless
+    // `need` truncates a power-of-2 transform (see fwd_b2).
+    static void forward(Vec* f, idt n, unsigned threads = 1, idt len = ~idt(0),
+                        idt need = ~idt(0)) {
         const int k = ntt_ctzll(n);
         const idt m = n >> k;
-        if (m == 1) { fwd_b2(f, n); return; }
+        if (n < PARALLEL_MIN_VECS) threads = 1;
+        if (len > n) len = n;
+        if (m == 1) { fwd_b2(f, n, threads, len, need); return; }
 
         const auto& roots = get_roots();
         const auto& ms_s = get_ms();
         const MontVec<B> mv(ms_s.mod, ms_s.niv, roots.img);
-
-        if (m == 3) Radix3Kernel<B, Mod>::dif_pass(f, n, mv, roots);
-        else        Radix5Kernel<B, Mod>::dif_pass(f, n, mv, roots);
-
         const idt sub_n = idt(1) << k;
-        for (idt i = 0; i < m; ++i)
-            fwd_b2(f + i * sub_n, sub_n);
+
+        parallel_for_rows(sub_n, threads, [&](idt lo, idt hi) {
+            for_live_runs(lo, hi, sub_n, int(m), len, [&](idt a, idt b, int live) {
+                if (live == 0) zero_rows(f, a, b, sub_n, int(m));
+                else           outer_pass<false>(f, n, m, mv, roots, a, b, live);
+            });
+        });
+
+        const unsigned sub_threads = unsigned((threads + m - 1) / m);
+        ThreadPool::instance().parallel_for(m, threads, [&](idt i) {
+            fwd_b2(f + i * sub_n, sub_n, sub_threads);
+        });
     }
 
     // Inverse NTT (DIT): inv_b2 on each sub-array, then outer radix-m DIT pass.
-    static void inverse(Vec* f, idt n) {
+    // Truncated mode: only f[0..len) is produced (the product length of a
+    // convolution); the final passes skip the rest.
+    // lazy: outputs may be left in [0, 2M) instead of [0, M).
+    static void inverse(Vec* f, idt n, unsigned threads = 1, idt len = ~idt(0),
+                        bool lazy = false) {
         const int k = ntt_ctzll(n);
         const idt m = n >> k;
-        if (m == 1) { inv_b2(f, n); return; }
+        if (n < PARALLEL_MIN_VECS) threads = 1;
+        if (len > n) len = n;
+        if (m == 1) { inv_b2(f, n, threads, len, lazy); return; }
 
+        // The radix-m DIT pass takes [0, 2M) inputs (its first step is a
+        // Montgomery multiply), so the sub-transforms skip their final pass.
         const idt sub_n = idt(1) << k;
-        for (idt i = 0; i < m; ++i)
-            inv_b2(f + i * sub_n, sub_n);
+        const unsigned sub_threads = unsigned((threads + m - 1) / m);
+        ThreadPool::instance().parallel_for(m, threads, [&](idt i) {
+            inv_b2(f + i * sub_n, sub_n, sub_threads, ~idt(0), true);
+        });
 
         const auto& roots = get_roots();
         const auto& ms_s = get_ms();
         const MontVec<B> mv(ms_s.mod, ms_s.niv, roots.img);
 
-        if (m == 3) Radix3Kernel<B, Mod>::dit_pass(f, n, mv, roots);
-        else        Radix5Kernel<B, Mod>::dit_pass(f, n, mv, roots);
+        parallel_for_rows((std::min)(sub_n, len), threads, [&](idt lo, idt hi) {
+            for_live_runs(lo, hi, sub_n, int(m), len, [&](idt a, idt b, int live) {
+                outer_pass<true>(f, n, m, mv, roots, a, b, live);
+            });
+        });
     }
 
     // Frequency-domain multiply (twisted convolution on each sub-array).
-    static void freq_multiply(Vec* f, Vec* g, idt n) {
+    // With threads > 1 each sub-array is cut into power-of-2 slices whose
+    // starting root comes from conv_root_jump.
+    // A power-of-2 transform truncated to f[0..need) (need a multiple of
+    // 4) is multiplied over that prefix only.
+    static void freq_multiply(Vec* f, const Vec* g, idt n, unsigned threads = 1,
+                              idt need = ~idt(0)) {
         const auto& roots = get_roots();
         const auto& ms_s = get_ms();
 
         const int k = ntt_ctzll(n);
         const idt m = n >> k;
         const idt sub_n = idt(1) << k;
+        const idt live = (m == 1 && need < n) ? need : sub_n;
+        if (n < PARALLEL_MIN_VECS) threads = 1;
 
-        if (m == 1) {
-            CyclicConv<B>::twisted_conv(f, g, n, ms_s, roots.img, roots.RT3);
+        // For mixed-radix: sub-array r needs twist offset ω_N^r where N = n vecs.
+        // ω_N = tw{m}_root[k] (primitive N-th root of unity).
+        u32 rr[15] = {ms_s.one};  // ω_N^0 = 1 for sub-array 0
+        if (m != 1) {
+            const u32 omega_N = (m == 3) ? roots.tw3_root[k]
+                              : (m == 5) ? roots.tw5_root[k] : roots.tw15_root[k];
+            for (idt i = 1; i < m; ++i) rr[i] = ms_s.mul_s(rr[i - 1], omega_N);
+        }
+
+        if (threads <= 1) {
+            for (idt i = 0; i < m; ++i)
+                CyclicConv<B>::twisted_conv(
+                    f + i * sub_n, g + i * sub_n, live,
+                    ms_s, roots.img, roots.RT3, rr[i]);
             return;
         }
 
-        // For mixed-radix: sub-array r needs twist offset ω_N^r where N = n vecs.
-        // ω_N = tw{m}_root[k] (primitive N-th root of unity).
-        const u32 omega_N = (m == 3) ? roots.tw3_root[k] : roots.tw5_root[k];
-        u32 rr = ms_s.one;  // ω_N^0 = 1 for sub-array 0
-        for (idt i = 0; i < m; ++i) {
+        // Slices of 2^q Vecs aligned to 2^q keep the ruler index pattern
+        // of the full chain, so each slice is an ordinary twisted_conv call.
+        int q = k;
+        while (q > LOG_BLOCK && (m << (k - q)) < idt(4) * threads) --q;
+        const idt per = idt(1) << (k - q);
+        ThreadPool::instance().parallel_for(m * per, threads, [&](idt task) {
+            const idt i = task / per, s = task % per;
+            const idt off = s << q;
+            if (off >= live) return;
             CyclicConv<B>::twisted_conv(
-                f + i * sub_n, g + i * sub_n, sub_n,
-                ms_s, roots.img, roots.RT3, rr);
-            rr = ms_s.mul_s(rr, omega_N);
-        }
+                f + i * sub_n + off, g + i * sub_n + off,
+                (std::min)(idt(1) << q, live - off),
+                ms_s, roots.img, roots.RT3, conv_root_jump(rr[i], off >> 2));
+        });
     }
 };
 
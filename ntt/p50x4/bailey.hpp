@@ -1,9 +1,14 @@
 #pragma once
 // bailey.hpp - Bailey's 4-step FFT for large power-of-2 transforms
 //
+// Each step (row FFTs, twiddle, transposes, column FFTs) is split over
+// num_threads() pool threads in contiguous blocks of rows.
+//
 // Part of ntt::p50x4 - 4-prime ~50-bit NTT (double FMA Barrett)
 
 #include "fft.hpp"
+#include "../profile.hpp"
+#include "../thread_pool.hpp"
 
 namespace ntt { namespace p50x4 {
 
@@ -64,20 +69,51 @@ static void transpose_rec(
     }
 }
 
+// Bailey steps run on the shared ThreadPool: body(begin, end) over one
+// contiguous block of [0, count) per thread (up to num_threads()), block
+// edges on multiples of grain.  Every step only reads the FftCtx (its
+// tables are grown before the first step).
+template<typename F>
+inline void bailey_for(std::size_t count, F&& body, std::size_t grain = 1) {
+    const unsigned t = num_threads();
+    const std::size_t parts = (std::min)(std::size_t(t), count / grain);
+    if (parts <= 1) {
+        body(std::size_t(0), count);
+        return;
+    }
+    const std::size_t units = count / grain;
+    ThreadPool::instance().parallel_for(idt(parts), unsigned(parts), [&](idt i) {
+        const std::size_t b = units * i / parts * grain;
+        const std::size_t e = (i + 1 == idt(parts)) ? count : units * (i + 1) / parts * grain;
+        body(b, e);
+    });
+}
+
+// A block of source rows goes out as TRANSPOSE_TILE-row strips (the
+// recursion needs multiple-of-4 tiles); each block fences its own
+// streaming stores before the pool's join.
 inline void bailey_transpose(double* dst, const double* src,
                               std::size_t R, std::size_t C) {
-    transpose_rec(dst, src, R, C, 0, 0, R, C);
-    _mm_sfence();
+    bailey_for(R, [&](std::size_t r0, std::size_t r1) {
+        if (r0 == 0 && r1 == R) {
+            transpose_rec(dst, src, R, C, 0, 0, R, C);
+        } else {
+            for (std::size_t r = r0; r < r1; r += TRANSPOSE_TILE)
+                transpose_rec(dst, src, R, C, r, 0, TRANSPOSE_TILE, C);
+        }
+        _mm_sfence();
+    }, TRANSPOSE_TILE);
 }
 
-// Apply twiddle factors: data[r][c] *= omega_N^{r*c}
-inline void bailey_twiddle_fwd(const FftCtx& Q, double* data,
-                                std::size_t R, std::size_t C, double omega_N) {
+// Rows [r_begin, r_end) of data: data[r][c] *= omega^{r*c}
+inline void bailey_twiddle_rows(const FftCtx& Q, double* data, std::size_t C, double omega,
+                                std::size_t r_begin, std::size_t r_end) {
     V4 n = v4_set1(Q.p), ninv = v4_set1(Q.pinv);
-    double omega_r = 1.0;
+    if (r_begin == 0) r_begin = 1;
+    double omega_r = s_powmod(omega, r_begin - 1, Q.p, Q.pinv);
 
-    for (std::size_t r = 1; r < R; ++r) {
-        omega_r = s_mulmod(omega_r, omega_N, Q.p, Q.pinv);
+    for (std::size_t r = r_begin; r < r_end; ++r) {
+        omega_r = s_mulmod(omega_r, omega, Q.p, Q.pinv);
         double step = omega_r;
         double* row = data + r * C;
 
@@ -113,47 +149,20 @@ inline void bailey_twiddle_fwd(const FftCtx& Q, double* data,
     }
 }
 
+// Apply twiddle factors: data[r][c] *= omega_N^{r*c}
+inline void bailey_twiddle_fwd(const FftCtx& Q, double* data,
+                                std::size_t R, std::size_t C, double omega_N) {
+    bailey_for(R, [&](std::size_t r0, std::size_t r1) {
+        bailey_twiddle_rows(Q, data, C, omega_N, r0, r1);
+    });
+}
+
 // Inverse twiddle: data[r][c] *= omega_N^{-r*c}
 inline void bailey_twiddle_inv(const FftCtx& Q, double* data,
                                 std::size_t R, std::size_t C, double omega_Ni) {
-    V4 n = v4_set1(Q.p), ninv = v4_set1(Q.pinv);
-    double omega_r = 1.0;
-
-    for (std::size_t r = 1; r < R; ++r) {
-        omega_r = s_mulmod(omega_r, omega_Ni, Q.p, Q.pinv);
-        double step = omega_r;
-        double* row = data + r * C;
-
-        V4 tw_step4;
-        V4 tw0 = v4_build_tw(1.0, step, Q.p, Q.pinv, tw_step4);
-        V4 tw1 = v4_mulmod(tw0, tw_step4, n, ninv);
-        V4 tw2 = v4_mulmod(tw1, tw_step4, n, ninv);
-        V4 tw3 = v4_mulmod(tw2, tw_step4, n, ninv);
-        V4 tw_step8 = v4_mulmod(tw_step4, tw_step4, n, ninv);
-        V4 tw_step16 = v4_mulmod(tw_step8, tw_step8, n, ninv);
-
-        std::size_t c = 0;
-        for (; c + 15 < C; c += 16) {
-            v4_store(row + c,      v4_mulmod(v4_load(row + c),      tw0, n, ninv));
-            v4_store(row + c + 4,  v4_mulmod(v4_load(row + c + 4),  tw1, n, ninv));
-            v4_store(row + c + 8,  v4_mulmod(v4_load(row + c + 8),  tw2, n, ninv));
-            v4_store(row + c + 12, v4_mulmod(v4_load(row + c + 12), tw3, n, ninv));
-            tw0 = v4_mulmod(tw0, tw_step16, n, ninv);
-            tw1 = v4_mulmod(tw1, tw_step16, n, ninv);
-            tw2 = v4_mulmod(tw2, tw_step16, n, ninv);
-            tw3 = v4_mulmod(tw3, tw_step16, n, ninv);
-        }
-        V4 tw = tw0;
-        for (; c + 3 < C; c += 4) {
-            v4_store(row + c, v4_mulmod(v4_load(row + c), tw, n, ninv));
-            tw = v4_mulmod(tw, tw_step4, n, ninv);
-        }
-        double running = _mm256_cvtsd_f64(tw);
-        for (; c < C; ++c) {
-            row[c] = s_mulmod(row[c], running, Q.p, Q.pinv);
-            running = s_mulmod(running, step, Q.p, Q.pinv);
-        }
-    }
+    bailey_for(R, [&](std::size_t r0, std::size_t r1) {
+        bailey_twiddle_rows(Q, data, C, omega_Ni, r0, r1);
+    });
 }
 
 // Bailey 4-step forward FFT for N = 2^L
@@ -173,20 +182,37 @@ inline void fft_bailey(FftCtx& Q, double* d, int L) {
     double* tmp = Q.ensure_bailey_tmp(N);
 
     // Step 1: C-point FFTs on each of R rows
-    for (std::size_t r = 0; r < R; ++r)
-        fft(Q, d + r * C, L2);
+    {
+        ProfileScope ps(PROF_BAILEY_ROWS);
+        bailey_for(R, [&](std::size_t r0, std::size_t r1) {
+            for (std::size_t r = r0; r < r1; ++r)
+                fft(Q, d + r * C, L2);
+        });
+    }
 
     // Step 2: Multiply by twiddle factors
-    bailey_twiddle_fwd(Q, d, R, C, omega_N);
+    {
+        ProfileScope ps(PROF_BAILEY_TWIDDLE);
+        bailey_twiddle_fwd(Q, d, R, C, omega_N);
+    }
 
     // Step 3: Transpose R*C -> C*R
-    bailey_transpose(tmp, d, R, C);
+    {
+        ProfileScope ps(PROF_BAILEY_TRANSPOSE);
+        bailey_transpose(tmp, d, R, C);
+    }
 
     // Step 4: R-point FFTs on each of C rows
-    for (std::size_t c = 0; c < C; ++c)
-        fft(Q, tmp + c * R, L1);
+    {
+        ProfileScope ps(PROF_BAILEY_COLUMNS);
+        bailey_for(C, [&](std::size_t c0, std::size_t c1) {
+            for (std::size_t c = c0; c < c1; ++c)
+                fft(Q, tmp + c * R, L1);
+        });
+    }
 
     // Step 5: Transpose back C*R -> R*C
+    ProfileScope ps(PROF_BAILEY_TRANSPOSE);
     bailey_transpose(d, tmp, C, R);
 }
 
@@ -207,21 +233,38 @@ inline void ifft_bailey(FftCtx& Q, double* d, int L) {
     double* tmp = Q.ensure_bailey_tmp(N);
 
     // Step 1: Transpose R*C -> C*R
-    bailey_transpose(tmp, d, R, C);
+    {
+        ProfileScope ps(PROF_BAILEY_TRANSPOSE);
+        bailey_transpose(tmp, d, R, C);
+    }
 
     // Step 2: R-point IFFTs on each of C rows
-    for (std::size_t c = 0; c < C; ++c)
-        ifft(Q, tmp + c * R, L1);
+    {
+        ProfileScope ps(PROF_BAILEY_COLUMNS);
+        bailey_for(C, [&](std::size_t c0, std::size_t c1) {
+            for (std::size_t c = c0; c < c1; ++c)
+                ifft(Q, tmp + c * R, L1);
+        });
+    }
 
     // Step 3: Transpose back C*R -> R*C
-    bailey_transpose(d, tmp, C, R);
+    {
+        ProfileScope ps(PROF_BAILEY_TRANSPOSE);
+        bailey_transpose(d, tmp, C, R);
+    }
 
     // Step 4: Inverse twiddle
-    bailey_twiddle_inv(Q, d, R, C, omega_Ni);
+    {
+        ProfileScope ps(PROF_BAILEY_TWIDDLE);
+        bailey_twiddle_inv(Q, d, R, C, omega_Ni);
+    }
 
     // Step 5: C-point IFFTs on each of R rows
-    for (std::size_t r = 0; r < R; ++r)
-        ifft(Q, d + r * C, L2);
+    ProfileScope ps(PROF_BAILEY_ROWS);
+    bailey_for(R, [&](std::size_t r0, std::size_t r1) {
+        for (std::size_t r = r0; r < r1; ++r)
+            ifft(Q, d + r * C, L2);
+    });
 }
 
 }} // namespace ntt::p50x4
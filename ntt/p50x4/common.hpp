@@ -35,13 +35,14 @@ inline double* alloc_doubles(std::size_t count, std::size_t align = 4096) {
     std::size_t bytes = count * sizeof(double);
     bytes = (bytes + align - 1) / align * align;
     if (bytes == 0) bytes = align;
-    void* p = ::operator new(bytes, std::align_val_t(align));
+    void* p = aligned_alloc_bytes(bytes, align);
+    if (!p) throw std::bad_alloc();
     std::memset(p, 0, bytes);
     return static_cast<double*>(p);
 }
 
 inline void free_doubles(void* p) {
-    if (p) ::operator delete(p, std::align_val_t(4096));
+    if (p) aligned_free_bytes(p);
 }
 
 // ================================================================
@@ -65,6 +66,16 @@ inline double s_mulmod(double a, double b, double n, double ninv) {
     return std::fma(-q, n, h) + l;
 }
 
+// a^e mod n by squaring (s_mulmod range in and out)
+inline double s_powmod(double a, u64 e, double n, double ninv) {
+    double r = 1.0;
+    for (; e; e >>= 1) {
+        if (e & 1) r = s_mulmod(r, a, n, ninv);
+        a = s_mulmod(a, a, n, ninv);
+    }
+    return r;
+}
+
 inline double s_reduce_pm1n(double a, double n, double ninv) {
     return std::fma(-std::nearbyint(a * ninv), n, a);
 }
@@ -270,10 +270,12 @@ static void crt_reconstruct(
 {
     u64 p0 = C->p[0], p1 = C->p[1], p2 = C->p[2];
     std::size_t ngroups = ncoeffs / 4;
+    // Group g adds in from limb 5g on; later groups cannot reach z[0..zn)
+    std::size_t live_groups = (std::min)(ngroups, (zn + 4) / 5);
 
     std::memset(z, 0, zn * sizeof(u64));
 
-    for (std::size_t g = 0; g < ngroups; g++)
+    for (std::size_t g = 0; g < live_groups; g++)
     {
         u64 a0[4], a1[4], a2[4], a3[4];
         garner_phase1(C, d0, d1, d2, d3, g * 4, a0, a1, a2, a3);
@@ -291,7 +293,7 @@ static void crt_reconstruct(
 
     // Tail: remaining 0-3 coefficients
     std::size_t rem = ncoeffs - ngroups * 4;
-    if (rem > 0)
+    if (rem > 0 && live_groups == ngroups)
     {
         std::size_t base = ngroups * 4;
 
@@ -5,6 +5,9 @@
 
 #include "mixed_radix.hpp"
 #include "crt.hpp"
+#include "../arena.hpp"
+#include "../profile.hpp"
+#include "../thread_pool.hpp"
 
 namespace ntt { namespace p50x4 {
 
@@ -163,8 +166,19 @@ inline void convert_80bit_all_primes(double* out[4], const u64* limbs, std::size
 // ================================================================
 // Ntt4: 4-prime NTT multiply engine
 // ================================================================
+//
+// The primes are independent until the CRT.  From PARALLEL_PRIMES_MIN_N on,
+// with num_threads() > 1 and outside low-memory mode, their pipelines run
+// on up to four pool threads.  Each pipeline touches only its own FftCtx
+// (whose w2tab and Bailey workspace grow lazily) and its own buffers, so
+// the contexts are shared between threads without locking; the pool's join
+// orders their updates before the next call.  An Ntt4 is still used by one
+// call at a time (instance() is per thread).
 class Ntt4 {
 public:
+    // Transform length from which the primes run in parallel.
+    static constexpr std::size_t PARALLEL_PRIMES_MIN_N = std::size_t(1) << 16;
+
     Ntt4() {
         for (int i = 0; i < 4; ++i)
             ctx_[i].init(PRIMES[i]);
@@ -192,6 +206,7 @@ public:
             return;
         }
 
+        ProfileScope ps_total(PROF_P50X4_TOTAL);
         bool is_sqr = (a == b && na == nb);
         std::size_t nca = n_coeffs_80(na);
         std::size_t ncb = is_sqr ? nca : n_coeffs_80(nb);
@@ -199,55 +214,185 @@ public:
         std::size_t N = ceil_ntt_size(conv_len);
         if (N < BLK_SZ) N = BLK_SZ;
 
+        // Transform buffers are recycled through the NTTArena, so they are
+        // not zero: pad each one explicitly.  Parallel primes need one b
+        // buffer each, a sequential run shares one.
+        const unsigned width = prime_threads(N);
+        const int nfb = is_sqr ? 0 : (width > 1 ? 4 : 1);
+        NTTArena& arena = NTTArena::instance();
+        double* buf[8] = {};
+        take_doubles(arena, buf, 4 + nfb, N);
         double* fa[4];
-        for (int i = 0; i < 4; i++)
-            fa[i] = alloc_doubles(N);
+        double* fb[4] = {};
+        for (int i = 0; i < 4; i++) {
+            fa[i] = NTTArena::raw(buf[i]);
+            if (nfb) fb[i] = NTTArena::raw(buf[4 + (nfb > 1 ? i : 0)]);
+        }
 
-        convert_80bit_all_primes(fa, a, na, ctx_);
+        {
+            ProfileScope ps(PROF_P50X4_CONVERT);
+            convert_80bit_all_primes(fa, a, na, ctx_);
+            for (int i = 0; i < 4; i++)
+                std::memset(fa[i] + nca, 0, (N - nca) * sizeof(double));
+        }
 
-        double* fb = is_sqr ? nullptr : alloc_doubles(N);
+        try {
+            for_primes(width, [&](int pi) {
+                auto& Q = ctx_[pi];
+
+                if (!is_sqr) {
+                    ProfileScope ps(PROF_P50X4_CONVERT);
+                    convert_80bit_to_double(fb[pi], b, nb, Q);
+                    std::memset(fb[pi] + ncb, 0, (N - ncb) * sizeof(double));
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_FORWARD);
+                    fft_mixed(Q, fa[pi], N);
+                    if (!is_sqr) fft_mixed(Q, fb[pi], N);
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_POINTMUL);
+                    if (is_sqr) point_sqr(Q, fa[pi], N);
+                    else point_mul(Q, fa[pi], fb[pi], N);
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_INVERSE);
+                    ifft_mixed(Q, fa[pi], N);
+                    scale_mixed(Q, fa[pi], conv_len, N);
+                }
+            });
+        } catch (...) {
+            give_doubles(arena, buf, 4 + nfb, N);
+            throw;
+        }
+        give_doubles(arena, buf + 4, nfb, N);
 
-        for (int pi = 0; pi < 4; ++pi) {
-            auto& Q = ctx_[pi];
+        finish(out, out_len, fa, conv_len, na + nb);
+        give_doubles(arena, buf, 4, N);
+    }
 
-            if (!is_sqr) {
-                convert_80bit_to_double(fb, b, nb, Q);
-                std::memset(fb + ncb, 0, (N - ncb) * sizeof(double));
-            }
-            fft_mixed(Q, fa[pi], N);
-            if (is_sqr) {
-                point_sqr(Q, fa[pi], N);
-            } else {
-                fft_mixed(Q, fb, N);
-                point_mul(Q, fa[pi], fb, N);
-            }
-            ifft_mixed(Q, fa[pi], N);
+    // Transform length used for an na x nb product.
+    static std::size_t transform_size(std::size_t na, std::size_t nb) {
+        std::size_t N = ceil_ntt_size(n_coeffs_80(na) + n_coeffs_80(nb) - 1);
+        return N < BLK_SZ ? BLK_SZ : N;
+    }
 
-            scale_mixed(Q, fa[pi], conv_len, N);
+    // Forward transforms of a[0..na) for all four primes at length N into
+    // fa[0..3] (each N doubles), for reuse by multiply_prepared().
+    void prepare(double* fa[4], std::size_t N, const u64* a, std::size_t na) {
+        std::size_t nca = n_coeffs_80(na);
+        {
+            ProfileScope ps(PROF_P50X4_CONVERT);
+            convert_80bit_all_primes(fa, a, na, ctx_);
         }
-        if (fb) free_doubles(fb);
+        ProfileScope ps(PROF_P50X4_FORWARD);
+        for_primes(prime_threads(N), [&](int pi) {
+            std::memset(fa[pi] + nca, 0, (N - nca) * sizeof(double));
+            fft_mixed(ctx_[pi], fa[pi], N);
+        });
+    }
 
-        // CRT reconstruct
-        std::size_t zn = (80 * conv_len + 256 + 63) / 64;
-        // Use a temporary buffer for CRT output, then copy to out
-        std::vector<u64> z(zn, 0);
-        crt_reconstruct(&crt_, z.data(), z.size(),
-                        fa[0], fa[1], fa[2], fa[3], conv_len);
+    // out = A * b where fa holds prepare()'d transforms of the na-limb A.
+    // Requires transform_size(na, nb) <= N.  fa is only read.
+    void multiply_prepared(u64* out, std::size_t out_len,
+                           const double* const fa[4], std::size_t na, std::size_t N,
+                           const u64* b, std::size_t nb) {
+        if (na == 0 || nb == 0) {
+            std::memset(out, 0, out_len * sizeof(u64));
+            return;
+        }
 
-        for (int i = 0; i < 4; i++) free_doubles(fa[i]);
+        ProfileScope ps_total(PROF_P50X4_TOTAL);
+        std::size_t ncb = n_coeffs_80(nb);
+        std::size_t conv_len = n_coeffs_80(na) + ncb - 1;
+
+        NTTArena& arena = NTTArena::instance();
+        double* buf[4] = {};
+        double* fr[4];
+        take_doubles(arena, buf, 4, N);
+        for (int pi = 0; pi < 4; ++pi) fr[pi] = NTTArena::raw(buf[pi]);
+        try {
+            for_primes(prime_threads(N), [&](int pi) {
+                auto& Q = ctx_[pi];
+                {
+                    ProfileScope ps(PROF_P50X4_CONVERT);
+                    convert_80bit_to_double(fr[pi], b, nb, Q);
+                    std::memset(fr[pi] + ncb, 0, (N - ncb) * sizeof(double));
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_FORWARD);
+                    fft_mixed(Q, fr[pi], N);
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_POINTMUL);
+                    point_mul(Q, fr[pi], fa[pi], N);
+                }
+                {
+                    ProfileScope ps(PROF_P50X4_INVERSE);
+                    ifft_mixed(Q, fr[pi], N);
+                    scale_mixed(Q, fr[pi], conv_len, N);
+                }
+            });
+        } catch (...) {
+            give_doubles(arena, buf, 4, N);
+            throw;
+        }
 
-        // Copy to output, trimming to actual product size
-        std::size_t product_len = na + nb;
-        std::size_t copy_len = (std::min)({product_len, out_len, z.size()});
-        std::memcpy(out, z.data(), copy_len * sizeof(u64));
-        if (copy_len < out_len)
-            std::memset(out + copy_len, 0, (out_len - copy_len) * sizeof(u64));
+        finish(out, out_len, fr, conv_len, na + nb);
+        give_doubles(arena, buf, 4, N);
     }
 
     const FftCtx* contexts() const { return ctx_; }
     const CrtCtx* crt() const { return &crt_; }
 
 private:
+    // Threads for the prime pipelines of a length-N transform.
+    static unsigned prime_threads(std::size_t N) {
+        const unsigned t = num_threads();
+        if (t <= 1 || N < PARALLEL_PRIMES_MIN_N || low_memory()) return 1;
+        return t < 4 ? t : 4;
+    }
+
+    // body(pi) for the four primes, on up to `width` threads.
+    template<typename F>
+    static void for_primes(unsigned width, F&& body) {
+        if (width <= 1) {
+            for (int pi = 0; pi < 4; ++pi) body(pi);
+            return;
+        }
+        ThreadPool::instance().parallel_for(4, width, [&](idt pi) { body(int(pi)); });
+    }
+
+    // buf[0..n) = n buffers of N doubles from the arena (tagged pointers;
+    // NTTArena::raw for the addresses).  Throws std::bad_alloc, having
+    // returned any already taken.
+    static void take_doubles(NTTArena& arena, double** buf, int n, std::size_t N) {
+        for (int i = 0; i < n; ++i) {
+            buf[i] = arena.alloc<double>(idt(N));
+            if (!buf[i]) {
+                give_doubles(arena, buf, i, N);
+                throw std::bad_alloc();
+            }
+        }
+    }
+
+    static void give_doubles(NTTArena& arena, double** buf, int n, std::size_t N) {
+        for (int i = n - 1; i >= 0; --i) arena.dealloc(buf[i], idt(N));
+    }
+
+    // CRT the four scaled residue arrays straight into out.  crt_reconstruct
+    // drops carries past the limbs it is given, so out[0..zn) receives the
+    // product mod 2^(64 zn) whatever out_len is; the operands have been
+    // consumed by now, so out may alias them.
+    void finish(u64* out, std::size_t out_len, double* fr[4],
+                std::size_t conv_len, std::size_t product_len) {
+        ProfileScope ps(PROF_P50X4_CRT);
+        std::size_t zn = (std::min)(product_len, out_len);
+        crt_reconstruct(&crt_, out, zn, fr[0], fr[1], fr[2], fr[3], conv_len);
+        if (zn < out_len)
+            std::memset(out + zn, 0, (out_len - zn) * sizeof(u64));
+    }
+
     FftCtx ctx_[4];
     CrtCtx crt_;
 };
@@ -0,0 +1,265 @@
+#pragma once
+// poly.hpp - Polynomial multiplication over the p30x3 NTT primes
+//
+// The p30x3 engine is an exact cyclic convolution over Z/pZ for its three
+// primes; big_multiply adds CRT and carry propagation on top of it.  Here
+// the same convolution is exposed for polynomials:
+//
+//   poly_mul_mod<Mod>  coefficients mod one prime (CRT_P0, CRT_P1 or
+//                      CRT_P2): a single convolution, no CRT.
+//   poly_mul_mod_u64   coefficients mod any u64 modulus: the exact integer
+//                      convolution from all three primes, reduced per
+//                      coefficient.  Moduli above 2^32 split coefficients
+//                      into 32-bit halves: per prime four forward
+//                      transforms, the cross products summed in the
+//                      frequency domain, three inverses.
+//
+// Both compute out[k] = sum_{i+j=k} a[i] * b[j] for k < out_len (zero past
+// na + nb - 1); a == b with na == nb is squared.  Operand coefficients at or
+// above out_len cannot reach the output and are dropped, and the inverse
+// transforms stop at out_len.  out may alias a or b.  The product length
+// na + nb - 1 is limited to P30X3_MAX_NTT, and for poly_mul_mod_u64, whose
+// cross terms sum two products per coefficient pair, to P30X3_MAX_CYCLIC_NTT.
+
+#include "api.hpp"
+
+namespace ntt {
+
+// x mod m (x < 2^88 from crt_recover)
+inline u64 mod_u128(u128 x, u64 m) {
+#if defined(_MSC_VER)
+    u64 r;
+    _udiv128(x.hi % m, x.lo, m, &r);
+    return r;
+#else
+    return u64(((unsigned __int128)(x.hi % m) << 64 | x.lo) % m);
+#endif
+}
+
+// a * b mod m for a, b < m
+inline u64 mulmod_u64(u64 a, u64 b, u64 m) {
+#if defined(_MSC_VER)
+    u64 hi, r;
+    const u64 lo = _umul128(a, b, &hi);
+    _udiv128(hi, lo, m, &r);
+    return r;
+#else
+    return u64((unsigned __int128)a * b % m);
+#endif
+}
+
+// a + b mod m for a, b < m
+inline u64 addmod_u64(u64 a, u64 b, u64 m) {
+    const u64 s = a + b;
+    return (s < a || s >= m) ? s - m : s;
+}
+
+// Convolution threads: the transforms are split only when large enough.
+inline unsigned poly_threads(idt N) {
+    return N >= PARALLEL_PRIMES_MIN_NTT ? num_threads() : 1;
+}
+
+template<typename B, u32 Mod>
+inline void poly_mul_mod_with(
+    u32* out, idt len,
+    const u32* a, idt na,
+    const u32* b, idt nb)
+{
+    assert(ntt_size_for<B>(na + nb - 1) <= P30X3_MAX_NTT);
+    const idt N = product_size_for<B>(na + nb - 1, poly_threads);
+
+    NTTArena& arena = NTTArena::instance();
+    u32* f = arena.alloc<u32>(N);
+    u32* g = arena.alloc<u32>(N);
+    auto* rf = NTTArena::raw(f);
+    auto* rg = NTTArena::raw(g);
+
+    const bool is_sqr = (a == b && na == nb);
+    reduce_and_pad<B, Mod>(rf, a, na, live_vecs<B>(na) * B::LANES);
+    ntt_conv_one_prime<B, Mod>(rf, rg, N / B::LANES, na, is_sqr ? nullptr : b, nb,
+                               live_vecs<B>(len), false, poly_threads(N));
+    // The inverse is lazy: [0, 2*Mod)
+    for (idt i = 0; i < len; ++i) out[i] = (rf[i] >= Mod) ? rf[i] - Mod : rf[i];
+
+    arena.dealloc(g, N);
+    arena.dealloc(f, N);
+}
+
+// out[0..out_len) = a * b with coefficients mod Mod, one of the p30x3
+// primes.  Input coefficients may be any u32; they are taken mod Mod.
+template<u32 Mod>
+inline void poly_mul_mod(
+    u32* out, idt out_len,
+    const u32* a, idt na,
+    const u32* b, idt nb)
+{
+    static_assert(Mod == CRT_P0 || Mod == CRT_P1 || Mod == CRT_P2,
+                  "poly_mul_mod: Mod must be a p30x3 prime");
+    if (na > out_len) na = out_len;
+    if (nb > out_len) nb = out_len;
+    if (na == 0 || nb == 0) {
+        std::memset(out, 0, out_len * sizeof(u32));
+        return;
+    }
+    const idt len = (std::min)(out_len, na + nb - 1);
+#ifdef NTT_HAS_AVX512
+    if (na + nb >= AVX512_MIN_NTT && cpu_has_avx512f())
+        poly_mul_mod_with<Avx512, Mod>(out, len, a, na, b, nb);
+    else
+#endif
+    poly_mul_mod_with<Avx2, Mod>(out, len, a, na, b, nb);
+    if (len < out_len) std::memset(out + len, 0, (out_len - len) * sizeof(u32));
+}
+
+// One prime of poly_mul_mod_u64.  r[0] (and r[2] when split) hold the low
+// (high) 32-bit halves of a, reduced; b's halves are reduced into t0, t1.
+// On return r[0] = lo*lo, and when split r[1] = lo*hi + hi*lo and
+// r[2] = hi*hi, each the first out_vecs Vecs, lazy.
+template<typename B, u32 Mod>
+inline void poly_u64_one_prime(
+    u32* const* r, u32* t0, u32* t1,
+    idt na, const u32* blo, const u32* bhi, idt nb,
+    idt ntt_vecs, idt out_vecs, bool split, unsigned threads)
+{
+    using Vec = typename B::Vec;
+    using S = NTTScheduler<B, Mod>;
+
+    if (!split) {
+        ntt_conv_one_prime<B, Mod>(r[0], t0, ntt_vecs, na, blo, nb, out_vecs, false, threads);
+        return;
+    }
+
+    const idt la = live_vecs<B>(na), lb = live_vecs<B>(nb);
+    S::forward((Vec*)r[0], ntt_vecs, threads, la);
+    S::forward((Vec*)r[2], ntt_vecs, threads, la);
+    if (blo) {
+        reduce_and_pad<B, Mod>(t0, blo, nb, lb * B::LANES);
+        reduce_and_pad<B, Mod>(t1, bhi, nb, lb * B::LANES);
+        S::forward((Vec*)t0, ntt_vecs, threads, lb);
+        S::forward((Vec*)t1, ntt_vecs, threads, lb);
+    } else {
+        // Squaring: b's spectra are a's
+        std::memcpy(t0, r[0], ntt_vecs * sizeof(Vec));
+        std::memcpy(t1, r[2], ntt_vecs * sizeof(Vec));
+    }
+
+    std::memcpy(r[1], r[0], ntt_vecs * sizeof(Vec));
+    S::freq_multiply((Vec*)r[1], (const Vec*)t1, ntt_vecs, threads);  // lo*hi
+    S::freq_multiply((Vec*)r[0], (const Vec*)t0, ntt_vecs, threads);  // lo*lo
+    S::freq_multiply((Vec*)t0, (const Vec*)r[2], ntt_vecs, threads);  // hi*lo
+    S::freq_multiply((Vec*)r[2], (const Vec*)t1, ntt_vecs, threads);  // hi*hi
+
+    // Cross terms: [0, 2M) + [0, 2M), back to [0, 2M) for the inverse
+    constexpr u32 Mod2 = 2 * Mod;
+    const idt n = ntt_vecs * B::LANES;
+    for (idt i = 0; i < n; ++i) {
+        const u32 s = r[1][i] + t0[i];
+        r[1][i] = (s >= Mod2) ? s - Mod2 : s;
+    }
+
+    for (int k = 0; k < 3; ++k)
+        S::inverse((Vec*)r[k], ntt_vecs, threads, out_vecs, true);
+}
+
+template<typename B>
+inline void poly_mul_mod_u64_with(
+    u64* out, idt len,
+    const u64* a, idt na,
+    const u64* b, idt nb, u64 mod)
+{
+    const idt N = ntt_size_for<B>(na + nb - 1);
+    assert(N <= P30X3_MAX_CYCLIC_NTT);
+    const idt ntt_vecs = N / B::LANES;
+    const idt out_vecs = live_vecs<B>(len);
+    const unsigned threads = poly_threads(N);
+
+    const bool is_sqr = (a == b && na == nb);
+    const bool split = mod > (u64(1) << 32);
+    const int parts = split ? 3 : 1;
+
+    // 32-bit halves of the coefficients (low halves only when mod <= 2^32)
+    u32* ah = aligned_alloc_array<u32, 64>(2 * na);
+    u32* bh = is_sqr ? nullptr : aligned_alloc_array<u32, 64>(2 * nb);
+    for (idt i = 0; i < na; ++i) {
+        ah[i] = u32(a[i]);
+        ah[na + i] = u32(a[i] >> 32);
+    }
+    for (idt i = 0; bh && i < nb; ++i) {
+        bh[i] = u32(b[i]);
+        bh[nb + i] = u32(b[i] >> 32);
+    }
+
+    // r[p][k]: prime p, product k (lo*lo, cross, hi*hi)
+    NTTArena& arena = NTTArena::instance();
+    u32* buf[3][3] = {};
+    u32* r[3][3] = {};
+    for (int p = 0; p < 3; ++p)
+        for (int k = 0; k < parts; ++k) {
+            buf[p][k] = arena.alloc<u32>(N);
+            r[p][k] = NTTArena::raw(buf[p][k]);
+        }
+    u32* tb0 = arena.alloc<u32>(N);
+    u32* tb1 = split ? arena.alloc<u32>(N) : nullptr;
+    auto* t0 = NTTArena::raw(tb0);
+    auto* t1 = split ? NTTArena::raw(tb1) : nullptr;
+
+    const idt pad = live_vecs<B>(na) * B::LANES;
+    reduce_and_pad3<B>(r[0][0], r[1][0], r[2][0], ah, na, pad);
+    if (split) reduce_and_pad3<B>(r[0][2], r[1][2], r[2][2], ah + na, na, pad);
+
+    const u32* blo = bh;
+    const u32* bhi = bh ? bh + nb : nullptr;
+    poly_u64_one_prime<B, CRT_P0>(r[0], t0, t1, na, blo, bhi, nb, ntt_vecs, out_vecs, split, threads);
+    poly_u64_one_prime<B, CRT_P1>(r[1], t0, t1, na, blo, bhi, nb, ntt_vecs, out_vecs, split, threads);
+    poly_u64_one_prime<B, CRT_P2>(r[2], t0, t1, na, blo, bhi, nb, ntt_vecs, out_vecs, split, threads);
+
+    // Each product coefficient is below min(na, nb) * 2^64 (twice that for
+    // the cross terms) < P0*P1*P2, so the CRT value is exact.
+    if (!split) {
+        for (idt i = 0; i < len; ++i)
+            out[i] = mod_u128(crt_recover(r[0][0][i], r[1][0][i], r[2][0][i]), mod);
+    } else {
+        const u64 s32 = (u64(1) << 32) % mod;
+        const u64 s64 = mulmod_u64(s32, s32, mod);
+        for (idt i = 0; i < len; ++i) {
+            const u64 ll = mod_u128(crt_recover(r[0][0][i], r[1][0][i], r[2][0][i]), mod);
+            const u64 lh = mod_u128(crt_recover(r[0][1][i], r[1][1][i], r[2][1][i]), mod);
+            const u64 hh = mod_u128(crt_recover(r[0][2][i], r[1][2][i], r[2][2][i]), mod);
+            out[i] = addmod_u64(addmod_u64(ll, mulmod_u64(lh, s32, mod), mod),
+                                mulmod_u64(hh, s64, mod), mod);
+        }
+    }
+
+    if (tb1) arena.dealloc(tb1, N);
+    arena.dealloc(tb0, N);
+    for (int p = 2; p >= 0; --p)
+        for (int k = parts - 1; k >= 0; --k) arena.dealloc(buf[p][k], N);
+    if (bh) aligned_free_array(bh);
+    aligned_free_array(ah);
+}
+
+// out[0..out_len) = a * b with coefficients mod `mod` (any modulus >= 2).
+// Input coefficients must be below mod.
+inline void poly_mul_mod_u64(
+    u64* out, idt out_len,
+    const u64* a, idt na,
+    const u64* b, idt nb, u64 mod)
+{
+    assert(mod >= 2);
+    if (na > out_len) na = out_len;
+    if (nb > out_len) nb = out_len;
+    if (na == 0 || nb == 0) {
+        std::memset(out, 0, out_len * sizeof(u64));
+        return;
+    }
+    const idt len = (std::min)(out_len, na + nb - 1);
+#ifdef NTT_HAS_AVX512
+    if (na + nb >= AVX512_MIN_NTT && cpu_has_avx512f())
+        poly_mul_mod_u64_with<Avx512>(out, len, a, na, b, nb, mod);
+    else
+#endif
+    poly_mul_mod_u64_with<Avx2>(out, len, a, na, b, nb, mod);
+    if (len < out_len) std::memset(out + len, 0, (out_len - len) * sizeof(u64));
+}
+
+} // namespace ntt
@@ -1,92 +1,453 @@
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
 
 namespace ntt {
 
 using profile_clock = std::chrono::high_resolution_clock;
 
+// ── Profiling buckets ──
+//
+// Wall time and call count per stage.  Nested stages are also counted in
+// their parents (api_total includes forward, ...).
+enum ProfBucket : int {
+    PROF_API_TOTAL,            // p30x3 products
+    PROF_API_REDUCE_PAD,
+    PROF_API_FORWARD,
+    PROF_API_FREQMUL,
+    PROF_API_INVERSE,
+    PROF_API_CRT,
+
+    PROF_P50X4_TOTAL,          // Ntt4 products
+    PROF_P50X4_CONVERT,
+    PROF_P50X4_FORWARD,
+    PROF_P50X4_POINTMUL,
+    PROF_P50X4_INVERSE,
+    PROF_P50X4_CRT,
+
+    PROF_BAILEY_ROWS,          // p50x4 Bailey 4-step stages (fwd + inv)
+    PROF_BAILEY_TWIDDLE,
+    PROF_BAILEY_TRANSPOSE,
+    PROF_BAILEY_COLUMNS,
+
+    PROF_BI_KARATSUBA,         // bi:: layer, above the basecases
+    PROF_BI_NTT,
+    PROF_BI_DIV_SCHOOLBOOK,
+    PROF_BI_DIV_NEWTON,
+    PROF_BI_TO_STRING,
+    PROF_BI_FROM_STRING,
+
+    PROF_NUM_BUCKETS
+};
+
+// Hardware events counted per bucket when the perf backend is on
+enum ProfHwEvent : int {
+    PROF_HW_CYCLES,
+    PROF_HW_INSTRUCTIONS,
+    PROF_HW_LLC_MISSES,
+    PROF_HW_DTLB_MISSES,
+
+    PROF_HW_NUM_EVENTS
+};
+
+// Name and dump indentation of each bucket
+struct ProfBucketInfo {
+    const char* name;
+    int depth;
+};
+
+inline const ProfBucketInfo& prof_bucket_info(int b) {
+    static const ProfBucketInfo info[PROF_NUM_BUCKETS] = {
+        {"api_total", 0},
+        {"reduce_pad", 1},
+        {"forward", 1},
+        {"freq_multiply", 1},
+        {"inverse", 1},
+        {"crt+carry", 1},
+        {"p50x4_total", 0},
+        {"convert", 1},
+        {"forward", 1},
+        {"pointmul", 1},
+        {"inverse", 1},
+        {"crt", 1},
+        {"bailey_rows", 2},
+        {"bailey_twiddle", 2},
+        {"bailey_transpose", 2},
+        {"bailey_columns", 2},
+        {"bi_karatsuba", 0},
+        {"bi_ntt", 0},
+        {"bi_div_schoolbook", 0},
+        {"bi_div_newton", 0},
+        {"bi_to_string", 0},
+        {"bi_from_string", 0},
+    };
+    return info[b];
+}
+
+// A snapshot of the counters (plain values; sum of any set of threads).
 struct ProfileCounters {
-    u64 api_total_ns = 0;
-    u64 api_reduce_pad_ns = 0;
-    u64 api_forward_ns = 0;
-    u64 api_freqmul_ns = 0;
-    u64 api_inverse_ns = 0;
-    u64 api_crt_ns = 0;
-
-    u64 sched_fwd_direct_ns = 0;
-    u64 sched_fwd_bailey_ns = 0;
-    u64 sched_bailey_prep_ns = 0;
-    u64 sched_bailey_stage1_ns = 0;
-    u64 sched_bailey_twiddle_ns = 0;
-    u64 sched_bailey_transpose_ns = 0;
-    u64 sched_bailey_stage2_ns = 0;
-    u64 sched_bailey_copy_ns = 0;
-    u64 sched_inv_ns = 0;
-    u64 sched_freqmul_ns = 0;
+    u64 ns[PROF_NUM_BUCKETS] = {};
+    u64 calls[PROF_NUM_BUCKETS] = {};
+    u64 hw[PROF_NUM_BUCKETS][PROF_HW_NUM_EVENTS] = {};
+
+    ProfileCounters& operator+=(const ProfileCounters& o) {
+        for (int b = 0; b < PROF_NUM_BUCKETS; ++b) {
+            ns[b] += o.ns[b];
+            calls[b] += o.calls[b];
+            for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e) hw[b][e] += o.hw[b][e];
+        }
+        return *this;
+    }
+
+    double ms(ProfBucket b) const { return double(ns[b]) / 1.0e6; }
 };
 
-inline ProfileCounters& profile_counters() {
-    static ProfileCounters c{};
-    return c;
+// Live counters of one thread or one capture.  Added to with relaxed atomics
+// so snapshots taken from another thread are race-free; the adds are
+// uncontended except on a capture shared by a parallel_for.
+struct ProfileSlot {
+    std::atomic<u64> ns[PROF_NUM_BUCKETS] = {};
+    std::atomic<u64> calls[PROF_NUM_BUCKETS] = {};
+    std::atomic<u64> hw[PROF_NUM_BUCKETS][PROF_HW_NUM_EVENTS] = {};
+    ProfileSlot* parent = nullptr;   // enclosing capture, also credited
+
+    // hw_delta: PROF_HW_NUM_EVENTS counts, or nullptr without the perf backend
+    void add(int b, u64 t, const u64* hw_delta) {
+        ns[b].fetch_add(t, std::memory_order_relaxed);
+        calls[b].fetch_add(1, std::memory_order_relaxed);
+        if (hw_delta)
+            for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e)
+                hw[b][e].fetch_add(hw_delta[e], std::memory_order_relaxed);
+    }
+
+    void read_into(ProfileCounters& c) const {
+        for (int b = 0; b < PROF_NUM_BUCKETS; ++b) {
+            c.ns[b] += ns[b].load(std::memory_order_relaxed);
+            c.calls[b] += calls[b].load(std::memory_order_relaxed);
+            for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e)
+                c.hw[b][e] += hw[b][e].load(std::memory_order_relaxed);
+        }
+    }
+
+    void clear() {
+        for (int b = 0; b < PROF_NUM_BUCKETS; ++b) {
+            ns[b].store(0, std::memory_order_relaxed);
+            calls[b].store(0, std::memory_order_relaxed);
+            for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e)
+                hw[b][e].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Every thread's slot, plus the totals of threads that have exited.
+class ProfileRegistry {
+    std::mutex mu_;
+    std::vector<ProfileSlot*> live_;
+    ProfileCounters retired_;
+
+public:
+    // Never destroyed: pool workers detach during static destruction.
+    static ProfileRegistry& instance() {
+        static ProfileRegistry* reg = new ProfileRegistry;
+        return *reg;
+    }
+
+    void attach(ProfileSlot* s) {
+        std::lock_guard<std::mutex> lk(mu_);
+        live_.push_back(s);
+    }
+
+    void detach(ProfileSlot* s) {
+        std::lock_guard<std::mutex> lk(mu_);
+        s->read_into(retired_);
+        for (std::size_t i = 0; i < live_.size(); ++i) {
+            if (live_[i] == s) {
+                live_[i] = live_.back();
+                live_.pop_back();
+                break;
+            }
+        }
+    }
+
+    ProfileCounters snapshot() {
+        std::lock_guard<std::mutex> lk(mu_);
+        ProfileCounters c = retired_;
+        for (ProfileSlot* s : live_) s->read_into(c);
+        return c;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lk(mu_);
+        retired_ = ProfileCounters{};
+        for (ProfileSlot* s : live_) s->clear();
+    }
+};
+
+struct ThreadProfile {
+    ProfileSlot slot;
+    ThreadProfile() { ProfileRegistry::instance().attach(&slot); }
+    ~ThreadProfile() { ProfileRegistry::instance().detach(&slot); }
+};
+
+inline ProfileSlot& profile_thread_slot() {
+    static thread_local ThreadProfile tp;
+    return tp.slot;
 }
 
-inline bool profile_enabled() {
-    static const bool enabled = []() {
+// Innermost ProfileCapture active on this thread (nullptr if none).
+// parallel_for hands the caller's sink to the workers running its body.
+inline ProfileSlot*& profile_sink() {
+    static thread_local ProfileSlot* sink = nullptr;
+    return sink;
+}
+
+struct ProfileSinkGuard {
+    ProfileSlot* saved;
+    explicit ProfileSinkGuard(ProfileSlot* s) : saved(profile_sink()) { profile_sink() = s; }
+    ~ProfileSinkGuard() { profile_sink() = saved; }
+};
+
+// ── Runtime switch ──
+// Initially on iff NTT_PROFILE=1 in the environment.
+inline std::atomic<bool>& profile_enabled_ref() {
+    static std::atomic<bool> on{[] {
         const char* p = std::getenv("NTT_PROFILE");
         return p && p[0] == '1';
-    }();
-    return enabled;
+    }()};
+    return on;
 }
 
+inline bool profile_enabled() {
+    return profile_enabled_ref().load(std::memory_order_relaxed);
+}
+
+inline void profile_set_enabled(bool on) {
+    profile_enabled_ref().store(on, std::memory_order_relaxed);
+}
+
+// ── Hardware counter backend (Linux perf_event_open) ──
+//
+// One counter group per thread (cycles, instructions, LLC misses, dTLB load
+// misses; user mode only), opened on first use and read at both ends of each
+// ProfileScope.  Off unless NTT_PROFILE_HW=1 or profile_set_hw(true).  Where
+// the events cannot be opened (non-Linux, perf_event_paranoid, VMs without a
+// PMU) the scopes fall back to wall time only.  Events the CPU lacks are
+// left out of the group and read as zero.
+class PerfGroup {
+#if defined(__linux__)
+    int fd_[PROF_HW_NUM_EVENTS];
+    int pos_[PROF_HW_NUM_EVENTS];   // index in the group read, -1 if not open
+    int leader_ = -1;
+    int nr_ = 0;
+
+    static int open_event(u32 type, u64 config, int group) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = (group == -1);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+    }
+
+public:
+    PerfGroup() {
+        static const struct { u32 type; u64 config; } events[PROF_HW_NUM_EVENTS] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        };
+        for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e) fd_[e] = pos_[e] = -1;
+        for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e) {
+            fd_[e] = open_event(events[e].type, events[e].config, leader_);
+            if (fd_[e] < 0) {
+                if (e == 0) return;   // no cycles, no group
+                continue;
+            }
+            if (e == 0) leader_ = fd_[0];
+            pos_[e] = nr_++;
+        }
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~PerfGroup() {
+        for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e)
+            if (fd_[e] >= 0) close(fd_[e]);
+    }
+
+    bool ok() const { return leader_ >= 0; }
+
+    // Current totals of this thread's events into v[PROF_HW_NUM_EVENTS]
+    bool read(u64* v) const {
+        u64 buf[1 + PROF_HW_NUM_EVENTS];
+        const ssize_t want = ssize_t((1 + nr_) * sizeof(u64));
+        if (::read(leader_, buf, sizeof(buf)) != want) return false;
+        for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e)
+            v[e] = pos_[e] >= 0 ? buf[1 + pos_[e]] : 0;
+        return true;
+    }
+#else
+public:
+    PerfGroup() = default;
+    bool ok() const { return false; }
+    bool read(u64*) const { return false; }
+#endif
+    PerfGroup(const PerfGroup&) = delete;
+    PerfGroup& operator=(const PerfGroup&) = delete;
+};
+
+// This thread's counter group, or nullptr if it could not be opened.
+inline const PerfGroup* profile_perf_group() {
+    static thread_local PerfGroup group;
+    return group.ok() ? &group : nullptr;
+}
+
+inline std::atomic<bool>& profile_hw_ref() {
+    static std::atomic<bool> on{[] {
+        const char* p = std::getenv("NTT_PROFILE_HW");
+        return p && p[0] == '1';
+    }()};
+    return on;
+}
+
+inline bool profile_hw_enabled() {
+    return profile_hw_ref().load(std::memory_order_relaxed);
+}
+
+inline void profile_set_hw(bool on) {
+    profile_hw_ref().store(on, std::memory_order_relaxed);
+}
+
+// Whether the counters can be opened (checked on the calling thread).
+inline bool profile_hw_available() {
+    return profile_perf_group() != nullptr;
+}
+
+// Times its lifetime into bucket b of this thread, and of every enclosing
+// capture.  Active when profiling is enabled or a capture is open.
 struct ProfileScope {
-    u64* bucket;
-    profile_clock::time_point t0;
+    int bucket;
     bool active;
+    const PerfGroup* perf = nullptr;
+    profile_clock::time_point t0;
+    u64 hw0[PROF_HW_NUM_EVENTS];
 
-    explicit ProfileScope(u64* b)
-        : bucket(b), t0(profile_clock::now()), active(profile_enabled()) {}
+    explicit ProfileScope(ProfBucket b)
+        : bucket(b), active(profile_enabled() || profile_sink() != nullptr) {
+        if (!active) return;
+        if (profile_hw_enabled()) {
+            perf = profile_perf_group();
+            if (perf && !perf->read(hw0)) perf = nullptr;
+        }
+        t0 = profile_clock::now();
+    }
 
     ~ProfileScope() {
         if (!active) return;
         const auto t1 = profile_clock::now();
-        *bucket += (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        const u64 ns = (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        u64 hw[PROF_HW_NUM_EVENTS];
+        const u64* hw_delta = nullptr;
+        if (perf && perf->read(hw)) {
+            for (int e = 0; e < PROF_HW_NUM_EVENTS; ++e) hw[e] -= hw0[e];
+            hw_delta = hw;
+        }
+        if (profile_enabled()) profile_thread_slot().add(bucket, ns, hw_delta);
+        for (ProfileSlot* s = profile_sink(); s; s = s->parent) s->add(bucket, ns, hw_delta);
+    }
+};
+
+// Per-call breakdown: counts everything run while it is alive, on this thread
+// and on the pool threads working for it, whether or not profiling is
+// enabled globally.
+//
+//     ntt::ProfileCapture prof;
+//     ntt::big_multiply_u64(out, out_len, a, na, b, nb);
+//     ntt::profile_dump(stdout, prof.counters());
+class ProfileCapture {
+    ProfileSlot slot_;
+    ProfileSlot* saved_;
+
+public:
+    ProfileCapture() : saved_(profile_sink()) {
+        slot_.parent = saved_;
+        profile_sink() = &slot_;
+    }
+    ~ProfileCapture() { profile_sink() = saved_; }
+    ProfileCapture(const ProfileCapture&) = delete;
+    ProfileCapture& operator=(const ProfileCapture&) = delete;
+
+    ProfileCounters counters() const {
+        ProfileCounters c;
+        slot_.read_into(c);
+        return c;
     }
 };
 
+// Sum over all threads, including exited ones, since the last reset.
+inline ProfileCounters profile_counters() {
+    return ProfileRegistry::instance().snapshot();
+}
+
+// Call while no profiled work is running.
 inline void profile_reset() {
-    profile_counters() = ProfileCounters{};
+    ProfileRegistry::instance().reset();
 }
 
 inline double ns_to_ms(u64 ns) {
     return double(ns) / 1.0e6;
 }
 
-inline void profile_dump(FILE* out = stdout) {
-    const auto& c = profile_counters();
+// With hardware counts: IPC, memory traffic as LLC-miss lines (64 bytes)
+// per cycle, and dTLB load misses per 1000 instructions.
+inline void profile_dump(FILE* out, const ProfileCounters& c) {
     if (!out) return;
 
-    std::fprintf(out, "=== NTT Profile (ms) ===\n");
-    std::fprintf(out, "api_total       : %.3f\n", ns_to_ms(c.api_total_ns));
-    std::fprintf(out, "  reduce_pad    : %.3f\n", ns_to_ms(c.api_reduce_pad_ns));
-    std::fprintf(out, "  forward       : %.3f\n", ns_to_ms(c.api_forward_ns));
-    std::fprintf(out, "  freq_multiply : %.3f\n", ns_to_ms(c.api_freqmul_ns));
-    std::fprintf(out, "  inverse       : %.3f\n", ns_to_ms(c.api_inverse_ns));
-    std::fprintf(out, "  crt+carry     : %.3f\n", ns_to_ms(c.api_crt_ns));
-
-    std::fprintf(out, "scheduler\n");
-    std::fprintf(out, "  fwd_direct    : %.3f\n", ns_to_ms(c.sched_fwd_direct_ns));
-    std::fprintf(out, "  fwd_bailey    : %.3f\n", ns_to_ms(c.sched_fwd_bailey_ns));
-    std::fprintf(out, "    prep        : %.3f\n", ns_to_ms(c.sched_bailey_prep_ns));
-    std::fprintf(out, "    stage1      : %.3f\n", ns_to_ms(c.sched_bailey_stage1_ns));
-    std::fprintf(out, "    twiddle     : %.3f\n", ns_to_ms(c.sched_bailey_twiddle_ns));
-    std::fprintf(out, "    transpose   : %.3f\n", ns_to_ms(c.sched_bailey_transpose_ns));
-    std::fprintf(out, "    stage2      : %.3f\n", ns_to_ms(c.sched_bailey_stage2_ns));
-    std::fprintf(out, "    copy        : %.3f\n", ns_to_ms(c.sched_bailey_copy_ns));
-    std::fprintf(out, "  inverse       : %.3f\n", ns_to_ms(c.sched_inv_ns));
-    std::fprintf(out, "  freq_multiply : %.3f\n", ns_to_ms(c.sched_freqmul_ns));
+    bool has_hw = false;
+    for (int b = 0; b < PROF_NUM_BUCKETS; ++b)
+        has_hw |= c.hw[b][PROF_HW_CYCLES] != 0;
+
+    std::fprintf(out, "=== NTT Profile ===\n");
+    std::fprintf(out, "%-22s %12s %10s", "stage", "ms", "calls");
+    if (has_hw) std::fprintf(out, " %10s %6s %7s %8s", "Mcycles", "IPC", "B/cyc", "dTLB/ki");
+    std::fprintf(out, "\n");
+    for (int b = 0; b < PROF_NUM_BUCKETS; ++b) {
+        if (c.calls[b] == 0) continue;
+        const ProfBucketInfo& info = prof_bucket_info(b);
+        std::fprintf(out, "%*s%-*s %12.3f %10llu", 2 * info.depth, "",
+                     22 - 2 * info.depth, info.name, ns_to_ms(c.ns[b]),
+                     (unsigned long long)c.calls[b]);
+        const u64* hw = c.hw[b];
+        if (has_hw && hw[PROF_HW_CYCLES]) {
+            const double cyc = double(hw[PROF_HW_CYCLES]);
+            const double ins = double(hw[PROF_HW_INSTRUCTIONS]);
+            std::fprintf(out, " %10.2f %6.2f %7.3f %8.3f", cyc / 1.0e6, ins / cyc,
+                         64.0 * double(hw[PROF_HW_LLC_MISSES]) / cyc,
+                         ins ? 1000.0 * double(hw[PROF_HW_DTLB_MISSES]) / ins : 0.0);
+        }
+        std::fprintf(out, "\n");
+    }
+}
+
+inline void profile_dump(FILE* out = stdout) {
+    profile_dump(out, profile_counters());
 }
 
 } // namespace ntt
@@ -15,6 +15,10 @@ struct Avx2 {
     NTT_FORCEINLINE static Vec loadu(const void* p) {
         return _mm256_loadu_si256((const Vec*)p);
     }
+    // Load 8 u32 (a root table entry); wider backends repeat them per 256 bits
+    NTT_FORCEINLINE static Vec load8(const void* p) {
+        return load(p);
+    }
     NTT_FORCEINLINE static void store(void* p, Vec x) {
         _mm256_store_si256((Vec*)p, x);
     }
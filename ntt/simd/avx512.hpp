@@ -0,0 +1,136 @@
+#pragma once
+#include "../common.hpp"
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#else
+  #include <cpuid.h>
+#endif
+
+namespace ntt {
+
+// Runtime check: CPU supports AVX-512F and the OS saves ZMM state.
+inline bool cpu_has_avx512f() {
+    static const bool ok = [] {
+        unsigned r[4] = {};
+#if defined(_MSC_VER)
+        int c[4];
+        __cpuid(c, 1);
+        r[2] = unsigned(c[2]);
+#else
+        if (!__get_cpuid(1, &r[0], &r[1], &r[2], &r[3])) return false;
+#endif
+        if (!(r[2] & (1u << 27))) return false;  // OSXSAVE
+
+        // XCR0: SSE, AVX, opmask, ZMM_Hi256, Hi16_ZMM
+#if defined(_MSC_VER)
+        const unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        const unsigned long long xcr0 = (unsigned long long)hi << 32 | lo;
+#endif
+        if ((xcr0 & 0xe6) != 0xe6) return false;
+
+#if defined(_MSC_VER)
+        __cpuidex(c, 7, 0);
+        r[1] = unsigned(c[1]);
+#else
+        if (!__get_cpuid_count(7, 0, &r[0], &r[1], &r[2], &r[3])) return false;
+#endif
+        return (r[1] & (1u << 16)) != 0;         // AVX512F
+    }();
+    return ok;
+}
+
+} // namespace ntt
+
+// The backend itself needs the compiler to target AVX-512F (-mavx512f /
+// -march=...); callers pair NTT_HAS_AVX512 with cpu_has_avx512f().
+#if defined(__AVX512F__)
+#define NTT_HAS_AVX512 1
+
+namespace ntt {
+
+struct Avx512 {
+    using Vec = __m512i;
+    static constexpr int LANES = 16;
+    static constexpr int LOG_LANES = 4;
+    static constexpr int ALIGN = 64;
+
+    NTT_FORCEINLINE static Vec load(const void* p) {
+        return _mm512_load_si512(p);
+    }
+    NTT_FORCEINLINE static Vec loadu(const void* p) {
+        return _mm512_loadu_si512(p);
+    }
+    // Load 8 u32 (a root table entry) and repeat them in both 256-bit halves
+    NTT_FORCEINLINE static Vec load8(const void* p) {
+        return _mm512_broadcast_i64x4(_mm256_load_si256((const __m256i*)p));
+    }
+    NTT_FORCEINLINE static void store(void* p, Vec x) {
+        _mm512_store_si512(p, x);
+    }
+    NTT_FORCEINLINE static Vec broadcast(u32 x) {
+        return _mm512_set1_epi32((i32)x);
+    }
+    NTT_FORCEINLINE static Vec add32(Vec a, Vec b) {
+        return _mm512_add_epi32(a, b);
+    }
+    NTT_FORCEINLINE static Vec sub32(Vec a, Vec b) {
+        return _mm512_sub_epi32(a, b);
+    }
+    NTT_FORCEINLINE static Vec min32(Vec a, Vec b) {
+        return _mm512_min_epu32(a, b);
+    }
+    NTT_FORCEINLINE static Vec mullo32(Vec a, Vec b) {
+        return _mm512_mullo_epi32(a, b);
+    }
+    // Even-lane 32x32->64 widening multiply
+    NTT_FORCEINLINE static Vec mul64(Vec a, Vec b) {
+        return _mm512_mul_epu32(a, b);
+    }
+    NTT_FORCEINLINE static Vec srl64(Vec a, int imm) {
+        return _mm512_srli_epi64(a, (unsigned)imm);
+    }
+    NTT_FORCEINLINE static Vec add64(Vec a, Vec b) {
+        return _mm512_add_epi64(a, b);
+    }
+    NTT_FORCEINLINE static Vec blend_0xaa(Vec a, Vec b) {
+        return _mm512_mask_blend_epi32(0xaaaa, a, b);
+    }
+    NTT_FORCEINLINE static Vec permutevar(Vec a, Vec idx) {
+        return _mm512_permutexvar_epi32(idx, a);
+    }
+    NTT_FORCEINLINE static Vec shuffle_AAAA(Vec a) {
+        return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)0x00);
+    }
+    NTT_FORCEINLINE static Vec shuffle_BBBB(Vec a) {
+        return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)0x55);
+    }
+    NTT_FORCEINLINE static Vec shuffle_CCCC(Vec a) {
+        return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)0xaa);
+    }
+    NTT_FORCEINLINE static Vec shuffle_DDDD(Vec a) {
+        return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)0xff);
+    }
+    NTT_FORCEINLINE static Vec shuffle_CDAB(Vec a) {
+        return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)0xb1);
+    }
+    // 8-lane pattern, repeated in both 256-bit halves (matches Avx2::setr
+    // for the lane-index vectors the kernels build)
+    NTT_FORCEINLINE static Vec setr(u32 a, u32 b, u32 c, u32 d,
+                                     u32 e, u32 f, u32 g, u32 h) {
+        return _mm512_setr_epi32((i32)a,(i32)b,(i32)c,(i32)d,
+                                 (i32)e,(i32)f,(i32)g,(i32)h,
+                                 (i32)a,(i32)b,(i32)c,(i32)d,
+                                 (i32)e,(i32)f,(i32)g,(i32)h);
+    }
+    NTT_FORCEINLINE static Vec zero() {
+        return _mm512_setzero_si512();
+    }
+};
+
+} // namespace ntt
+
+#endif // __AVX512F__
@@ -0,0 +1,172 @@
+#pragma once
+#include "common.hpp"
+#include "profile.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ntt {
+
+// ── Thread count (opt-in parallelism) ──
+//
+// Every parallel path in the library is gated on num_threads() > 1.
+// Default is 1: the library stays single-threaded unless asked.
+
+inline std::atomic<unsigned>& num_threads_ref() {
+    static std::atomic<unsigned> n{1};
+    return n;
+}
+
+inline unsigned num_threads() {
+    return num_threads_ref().load(std::memory_order_relaxed);
+}
+
+// n = 0 selects std::thread::hardware_concurrency().
+inline void set_num_threads(unsigned n) {
+    if (n == 0) n = std::thread::hardware_concurrency();
+    num_threads_ref().store(n ? n : 1, std::memory_order_relaxed);
+}
+
+// ── Persistent worker pool ──
+//
+// parallel_for(count, width, body) runs body(i) for i in [0, count) on at
+// most `width` threads, the calling thread included, and returns when all
+// indices are done.  The caller claims indices itself, so a body that calls
+// parallel_for again cannot deadlock: waiting only ever happens on indices
+// already claimed by a running thread.  Workers are spawned lazily and each
+// has its own NTTArena cache in front of the shared ArenaDepot.  The
+// caller's ProfileCapture, if any, also collects the time its workers spend
+// in body.  If body throws, the remaining indices are skipped, the job still
+// runs to completion, and the first exception is rethrown to the caller.
+class ThreadPool {
+    struct Job {
+        std::function<void(idt)> body;
+        idt count;
+        std::atomic<idt> next{0};
+        std::atomic<idt> done{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;  // first exception from body, under mu
+        std::mutex mu;
+        std::condition_variable cv;
+
+        explicit Job(idt n) : count(n) {}
+
+        // Never throws: an index is counted done even when body fails, so
+        // the caller's wait (which keeps body alive) always ends.
+        void run() {
+            for (;;) {
+                idt i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count) return;
+                if (!failed.load(std::memory_order_relaxed)) {
+                    try {
+                        body(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lk(mu);
+                        if (!error) error = std::current_exception();
+                        failed.store(true, std::memory_order_relaxed);
+                    }
+                }
+                if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                    std::lock_guard<std::mutex> lk(mu);
+                    cv.notify_all();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    void worker_loop() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+                if (stop_ && queue_.empty()) return;
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            job->run();
+        }
+    }
+
+public:
+    static constexpr unsigned MAX_WORKERS = 255;
+
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    unsigned size() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return unsigned(workers_.size());
+    }
+
+    // Grow the pool to at least `n` workers (never shrinks).
+    void reserve(unsigned n) {
+        if (n > MAX_WORKERS) n = MAX_WORKERS;
+        std::lock_guard<std::mutex> lk(mu_);
+        while (workers_.size() < n)
+            workers_.emplace_back([this] { worker_loop(); });
+    }
+
+    template<typename F>
+    void parallel_for(idt count, unsigned width, F&& body) {
+        if (count == 0) return;
+        if (width <= 1 || count == 1) {
+            for (idt i = 0; i < count; ++i) body(i);
+            return;
+        }
+        unsigned helpers = width - 1;
+        if (helpers > count - 1) helpers = unsigned(count - 1);
+        reserve(helpers);
+
+        // body outlives every call made through job->body: an index can only
+        // be claimed while done < count, i.e. while this frame is waiting.
+        auto job = std::make_shared<Job>(count);
+        ProfileSlot* sink = profile_sink();
+        job->body = [&body, sink](idt i) {
+            ProfileSinkGuard g(sink);
+            body(i);
+        };
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            for (unsigned h = 0; h < helpers; ++h) queue_.push_back(job);
+        }
+        if (helpers == 1) cv_.notify_one();
+        else cv_.notify_all();
+
+        job->run();
+        std::unique_lock<std::mutex> lk(job->mu);
+        job->cv.wait(lk, [&] {
+            return job->done.load(std::memory_order_acquire) == count;
+        });
+        if (job->error) std::rethrow_exception(job->error);
+    }
+};
+
+} // namespace ntt
@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <random>
+#include <vector>
 #include <chrono>
 #include <cassert>
 
@@ -754,6 +755,111 @@ static void test_bigint_multiply_ntt() {
     printf("  %d passed (this section)\n", g_pass - prev_pass);
 }
 
+static void test_mpn_short_products() {
+    printf("=== mpn mullo / mulhi ===\n");
+    int prev_pass = g_pass;
+
+    std::mt19937_64 rng(123);
+    // Basecase, Karatsuba (Mulders) and NTT range, around the thresholds
+    for (uint32_t n : {1u, 2u, 3u, 17u, 31u, 32u, 33u, 64u, 100u, 333u, 1023u, 1024u, 2500u}) {
+        limb_t* a = bi::mpn_alloc(n);
+        limb_t* b = bi::mpn_alloc(n);
+        limb_t* full = bi::mpn_alloc(2 * n);
+        limb_t* r = bi::mpn_alloc(n);
+        limb_t* d = bi::mpn_alloc(n);
+        for (int t = 0; t < 2; t++) {
+            // All-ones operands maximize the omitted partial products
+            for (uint32_t i = 0; i < n; i++) {
+                a[i] = t ? ~0ULL : rng();
+                b[i] = t ? ~0ULL : rng();
+            }
+            bi::mpn_mul(full, a, n, b, n);
+
+            bi::mpn_mullo_n(r, a, b, n);
+            CHECK(bi::mpn_cmp(r, full, n) == 0, "mullo n=%u", n);
+
+            bi::mpn_mulhi_n(r, a, b, n);
+            limb_t e = (n < bi::KARATSUBA_THRESHOLD || n >= bi::NTT_THRESHOLD) ? 1 : n;
+            limb_t borrow = bi::mpn_sub_n(d, full + n, r, n);
+            bool small = borrow == 0 && d[0] <= e && bi::mpn_normalize(d, n) <= 1;
+            CHECK(small, "mulhi n=%u within %llu of the high half",
+                  n, (unsigned long long)e);
+        }
+        bi::mpn_free(a);
+        bi::mpn_free(b);
+        bi::mpn_free(full);
+        bi::mpn_free(r);
+        bi::mpn_free(d);
+    }
+
+    printf("  %d passed (this section)\n", g_pass - prev_pass);
+}
+
+// a mod B^rn - 1 compared canonically (B^rn - 1 itself is zero)
+static bool bnm1_equal(const limb_t* x, const limb_t* y, uint32_t rn) {
+    auto all_ones = [rn](const limb_t* p) {
+        for (uint32_t i = 0; i < rn; i++) if (p[i] != ~0ULL) return false;
+        return true;
+    };
+    auto zero = [rn](const limb_t* p) { return bi::mpn_normalize(p, rn) == 0; };
+    if ((all_ones(x) || zero(x)) && (all_ones(y) || zero(y))) return true;
+    return bi::mpn_cmp(x, y, rn) == 0;
+}
+
+static void test_mpn_mulmod_bnm1() {
+    printf("=== mpn mulmod_bnm1 ===\n");
+    int prev_pass = g_pass;
+
+    std::mt19937_64 rng(321);
+    struct Case { uint32_t rn, an, bn; };
+    // rn below and above MULMOD_BNM1_THRESHOLD, fast and slow sizes;
+    // operands that wrap, that do not, and that are longer than rn
+    std::vector<Case> cases = {
+        {1, 1, 1}, {5, 3, 3}, {5, 7, 2}, {40, 30, 25}, {40, 20, 20}, {100, 250, 100},
+    };
+    for (uint32_t n : {1024u, 1500u, 4000u, 9000u}) {
+        uint32_t rn = bi::mpn_mulmod_bnm1_next_size(n);
+        cases.push_back({rn, rn, rn});
+        cases.push_back({rn, rn, rn / 2 + 1});
+        cases.push_back({rn, rn - 3, 7});
+        cases.push_back({rn, 2 * rn + 5, rn});
+        cases.push_back({rn + 1, rn, rn});
+    }
+    for (const Case& c : cases) {
+        for (int t = 0; t < 2; t++) {
+            limb_t* a = bi::mpn_alloc(c.an);
+            limb_t* b = bi::mpn_alloc(c.bn);
+            // All-ones operands: longest carry chains
+            for (uint32_t i = 0; i < c.an; i++) a[i] = t ? ~0ULL : rng();
+            for (uint32_t i = 0; i < c.bn; i++) b[i] = t ? ~0ULL : rng();
+
+            limb_t* full = bi::mpn_alloc(c.an + c.bn);
+            if (c.an >= c.bn) bi::mpn_mul(full, a, c.an, b, c.bn);
+            else bi::mpn_mul(full, b, c.bn, a, c.an);
+            limb_t* ref = bi::mpn_alloc(c.rn);
+            if (c.an + c.bn >= c.rn) {
+                bi::mpn_bnm1_fold(ref, c.rn, full, c.an + c.bn);
+            } else {
+                bi::mpn_copyi(ref, full, c.an + c.bn);
+                bi::mpn_zero(ref + c.an + c.bn, c.rn - c.an - c.bn);
+            }
+
+            limb_t* r = bi::mpn_alloc(c.rn);
+            bi::mpn_mulmod_bnm1(r, c.rn, a, c.an, b, c.bn);
+            CHECK(bnm1_equal(r, ref, c.rn), "mulmod_bnm1 rn=%u an=%u bn=%u ones=%d",
+                  c.rn, c.an, c.bn, t);
+
+            bi::mpn_free(a);
+            bi::mpn_free(b);
+            bi::mpn_free(full);
+            bi::mpn_free(ref);
+            bi::mpn_free(r);
+        }
+    }
+
+    printf("  %d passed (this section)\n", g_pass - prev_pass);
+}
+
 // ============================================================
 // Stage 3: Division tests
 // ============================================================
@@ -898,6 +1004,55 @@ static void test_bigint_div_random() {
     printf("  %d passed (this section)\n", g_pass - prev_pass);
 }
 
+// Newton division with divisors large enough for the wraparound products
+static void test_mpn_div_newton_large() {
+    printf("=== mpn division (Newton, large) ===\n");
+    int prev_pass = g_pass;
+
+    std::mt19937_64 rng(4242);
+    for (uint32_t dn : {1100u, 2100u, 5000u}) {
+        for (int t = 0; t < 3; t++) {
+            uint32_t nn = 2 * dn + 300 * (t + 1);
+            limb_t* np = bi::mpn_alloc(nn + 1);
+            limb_t* dp = bi::mpn_alloc(dn);
+            for (uint32_t i = 0; i < nn; i++) np[i] = rng();
+            for (uint32_t i = 0; i < dn; i++) dp[i] = rng();
+            if (t == 1) {
+                // D = B^dn - 1, N all ones: quotient limbs all near B - 1
+                for (uint32_t i = 0; i < dn; i++) dp[i] = ~0ULL;
+                for (uint32_t i = 0; i < nn; i++) np[i] = ~0ULL;
+            } else if (t == 2) {
+                // Top-heavy divisor: 2^63 * B^(dn-1) + small
+                bi::mpn_zero(dp + 1, dn - 1);
+                dp[dn - 1] = 1ULL << 63;
+            }
+            limb_t* n0 = bi::mpn_alloc(nn);
+            bi::mpn_copyi(n0, np, nn);
+
+            uint32_t qn = nn - dn + 1;
+            limb_t* qp = bi::mpn_alloc(qn);
+            bi::mpn_div_qr(qp, np, nn, dp, dn);
+
+            // N == Q*D + R and R < D
+            limb_t* chk = bi::mpn_alloc(qn + dn);
+            bi::mpn_mul(chk, qp, qn, dp, dn);
+            bi::mpn_add(chk, chk, qn + dn, np, dn);
+            bool ok = bi::mpn_cmp(chk, n0, nn) == 0 &&
+                      bi::mpn_normalize(chk + nn, qn + dn - nn) == 0 &&
+                      bi::mpn_cmp(np, dp, dn) < 0;
+            CHECK(ok, "newton div dn=%u nn=%u case=%d", dn, nn, t);
+
+            bi::mpn_free(np);
+            bi::mpn_free(dp);
+            bi::mpn_free(n0);
+            bi::mpn_free(qp);
+            bi::mpn_free(chk);
+        }
+    }
+
+    printf("  %d passed (this section)\n", g_pass - prev_pass);
+}
+
 // ============================================================
 // Stage 4: D&C Radix Conversion tests
 // ============================================================
@@ -1097,11 +1252,14 @@ int main() {
     test_bigint_multiply_random();
     test_bigint_sqr();
     test_bigint_multiply_ntt();
+    test_mpn_short_products();
+    test_mpn_mulmod_bnm1();
 
     // Stage 3: Division
     test_bigint_div_basic();
     test_bigint_div_multi_limb();
     test_bigint_div_random();
+    test_mpn_div_newton_large();
 
     // Stage 4: Radix conversion
     test_radix_known_values();
@@ -3,13 +3,19 @@
 // Tests the u64 4-prime sd_ntt path via the public API.
 
 #include "ntt/api.hpp"
+#include "ntt/poly.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
 #include <random>
+#include <stdexcept>
+#include <thread>
 
 using u64 = std::uint64_t;
+using u32 = std::uint32_t;
 
 // Schoolbook multiply for reference (u64 limbs)
 static void schoolbook_mul(u64* out, std::size_t out_len,
@@ -117,6 +123,1041 @@ static bool test_symmetric() {
     return true;
 }
 
+// Parallel prime mode must be bit-identical to the serial path.
+static bool test_parallel_matches_serial(std::size_t na, std::size_t nb, unsigned seed) {
+    // nb == 0 requests a squaring
+    printf("  parallel %zu x %zu limbs%s (seed=%u)... ",
+           na, nb ? nb : na, nb ? "" : " (sqr)", seed);
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+    const u64* bp = (nb == 0) ? a.data() : b.data();
+    if (nb == 0) nb = na;
+
+    std::size_t out_len = na + nb;
+    std::vector<u64> out_ser(out_len, 0), out_par(out_len, 0);
+
+    ntt::set_num_threads(1);
+    ntt::big_multiply_u64(out_ser.data(), out_len, a.data(), na, bp, nb);
+    ntt::set_num_threads(4);
+    ntt::big_multiply_u64(out_par.data(), out_len, a.data(), na, bp, nb);
+    ntt::set_num_threads(1);
+
+    if (out_ser != out_par) {
+        printf("FAIL: parallel result differs from serial\n");
+        return false;
+    }
+
+    printf("OK\n");
+    return true;
+}
+
+// Threaded NTTScheduler transforms must agree with the serial ones mod P
+// (lazy ranges may differ); inverse outputs are fully reduced.
+template<ntt::u32 Mod>
+static bool test_parallel_transform(std::size_t n_vecs, unsigned threads) {
+    using B = ntt::Avx2;
+    using Vec = B::Vec;
+    using S = ntt::NTTScheduler<B, Mod>;
+    printf("  threaded NTT %zu vecs, %u threads (P=%u)... ", n_vecs, threads, Mod);
+
+    std::size_t n32 = n_vecs * B::LANES;
+    std::mt19937 rng(unsigned(n_vecs) ^ Mod);
+    Vec* f = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+    Vec* g = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+    ntt::u32* fu = (ntt::u32*)f;
+    ntt::u32* gu = (ntt::u32*)g;
+    for (std::size_t i = 0; i < n32; ++i) fu[i] = gu[i] = rng() % Mod;
+
+    bool ok = true;
+    S::forward(f, n_vecs, 1);
+    S::forward(g, n_vecs, threads);
+    for (std::size_t i = 0; i < n32 && ok; ++i)
+        if (fu[i] % Mod != gu[i] % Mod) {
+            printf("FAIL: forward differs at %zu\n", i);
+            ok = false;
+        }
+    std::memcpy(gu, fu, n32 * sizeof(ntt::u32));
+    S::inverse(f, n_vecs, 1);
+    S::inverse(g, n_vecs, threads);
+    for (std::size_t i = 0; i < n32 && ok; ++i)
+        if (fu[i] != gu[i]) {
+            printf("FAIL: inverse differs at %zu\n", i);
+            ok = false;
+        }
+
+    ntt::aligned_free_array(f);
+    ntt::aligned_free_array(g);
+    if (ok) printf("OK\n");
+    return ok;
+}
+
+// Vector Garner CRT against the scalar reference, on random lazy residues in
+// [0, 2P) with extremes mixed in; long enough lengths also take the
+// streaming path.
+static bool test_crt_vector(std::size_t len, unsigned seed) {
+    printf("  vector CRT %zu coeffs (seed=%u)... ", len, seed);
+
+    std::mt19937 rng(seed);
+    const ntt::u32 P[3] = {ntt::CRT_P0, ntt::CRT_P1, ntt::CRT_P2};
+    std::vector<ntt::u32> r[3];
+    for (int p = 0; p < 3; ++p) {
+        r[p].resize(len);
+        for (auto& v : r[p]) {
+            unsigned k = rng() % 8;
+            v = (k == 0) ? 0 : (k == 1) ? P[p] - 1 : (k == 2) ? 2 * P[p] - 1
+              : (k == 3) ? P[p] + rng() % P[p] : rng() % P[p];
+        }
+    }
+    ntt::u32* out = ntt::aligned_alloc_array<ntt::u32, 64>(len + 1);
+    std::vector<ntt::u32> ref(len);
+    ntt::crt_and_propagate(out, len, r[0].data(), r[1].data(), r[2].data());
+    ntt::crt_and_propagate_scalar(ref.data(), len, r[0].data(), r[1].data(), r[2].data());
+    bool ok = std::memcmp(out, ref.data(), len * sizeof(ntt::u32)) == 0;
+    ntt::aligned_free_array(out);
+
+    printf(ok ? "OK\n" : "FAIL: differs from scalar CRT\n");
+    return ok;
+}
+
+// Fused three-prime reduction must match three reduce_and_pad passes,
+// including inputs near 2^32 and the unaligned scalar tail.
+static bool test_reduce_and_pad3(std::size_t len, unsigned seed) {
+    using B = ntt::Avx2;
+    printf("  fused reduce %zu elements (seed=%u)... ", len, seed);
+
+    std::mt19937 rng(seed);
+    std::vector<ntt::u32> src(len);
+    for (auto& v : src) {
+        unsigned k = rng() % 4;
+        v = (k == 0) ? 0xFFFFFFFFu - rng() % 16 : rng();
+    }
+    const std::size_t N = ntt::live_vecs<B>(len) * B::LANES + 2 * B::LANES;
+    const std::size_t pad = ntt::live_vecs<B>(len) * B::LANES;
+    ntt::u32* f[3];
+    ntt::u32* r[3];
+    for (int p = 0; p < 3; ++p) {
+        f[p] = ntt::aligned_alloc_array<ntt::u32, 64>(N);
+        r[p] = ntt::aligned_alloc_array<ntt::u32, 64>(N);
+        std::memset(f[p], 0xab, N * sizeof(ntt::u32));
+        std::memset(r[p], 0xab, N * sizeof(ntt::u32));
+    }
+    ntt::reduce_and_pad3<B>(f[0], f[1], f[2], src.data(), len, pad);
+    ntt::reduce_and_pad<B, ntt::CRT_P0>(r[0], src.data(), len, pad);
+    ntt::reduce_and_pad<B, ntt::CRT_P1>(r[1], src.data(), len, pad);
+    ntt::reduce_and_pad<B, ntt::CRT_P2>(r[2], src.data(), len, pad);
+    bool ok = true;
+    for (int p = 0; p < 3; ++p) {
+        ok &= std::memcmp(f[p], r[p], N * sizeof(ntt::u32)) == 0;
+        ntt::aligned_free_array(f[p]);
+        ntt::aligned_free_array(r[p]);
+    }
+
+    printf(ok ? "OK\n" : "FAIL: differs from per-prime reduction\n");
+    return ok;
+}
+
+// Pruned transforms: forward with only f[0..len) initialized (the tail is
+// filled with garbage) must match the zero-padded transform, and the
+// truncated lazy inverse must match the first len Vecs of the full inverse
+// up to one multiple of Mod.
+template<ntt::u32 Mod>
+static bool test_pruned_transform(std::size_t n_vecs, std::size_t len, unsigned threads) {
+    using B = ntt::Avx2;
+    using Vec = B::Vec;
+    using S = ntt::NTTScheduler<B, Mod>;
+    printf("  pruned NTT %zu vecs, len %zu, %u threads (P=%u)... ",
+           n_vecs, len, threads, Mod);
+
+    std::size_t n32 = n_vecs * B::LANES, l32 = len * B::LANES;
+    std::mt19937 rng(unsigned(n_vecs * 31 + len) ^ Mod);
+    Vec* f = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+    Vec* g = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+    ntt::u32* fu = (ntt::u32*)f;
+    ntt::u32* gu = (ntt::u32*)g;
+    for (std::size_t i = 0; i < n32; ++i) {
+        fu[i] = (i < l32) ? rng() % Mod : 0;
+        gu[i] = (i < l32) ? fu[i] : rng();
+    }
+
+    bool ok = true;
+    S::forward(f, n_vecs, 1);
+    S::forward(g, n_vecs, threads, len);
+    for (std::size_t i = 0; i < n32 && ok; ++i)
+        if (fu[i] % Mod != gu[i] % Mod) {
+            printf("FAIL: forward differs at %zu\n", i);
+            ok = false;
+        }
+    std::memcpy(gu, fu, n32 * sizeof(ntt::u32));
+    S::inverse(f, n_vecs, 1);
+    S::inverse(g, n_vecs, threads, len, true);
+    for (std::size_t i = 0; i < l32 && ok; ++i)
+        if (gu[i] >= 2 * Mod || fu[i] != gu[i] % Mod) {
+            printf("FAIL: inverse differs at %zu\n", i);
+            ok = false;
+        }
+
+    ntt::aligned_free_array(f);
+    ntt::aligned_free_array(g);
+    if (ok) printf("OK\n");
+    return ok;
+}
+
+// Truncated transforms: a product of `vecs` Vecs through the forwards and
+// pointwise products truncated to tft_length and inverse_tft must match the
+// full transforms on those Vecs, whatever the skipped tail holds.
+template<ntt::u32 Mod>
+static bool test_truncated_transform(std::size_t n_vecs, std::size_t vecs) {
+    using B = ntt::Avx2;
+    using Vec = B::Vec;
+    using S = ntt::NTTScheduler<B, Mod>;
+    const std::size_t need = ntt::tft_length(n_vecs, vecs);
+    printf("  truncated NTT %zu vecs, product %zu, need %zu (P=%u)... ",
+           n_vecs, vecs, need, Mod);
+
+    std::size_t n32 = n_vecs * B::LANES;
+    std::mt19937 rng(unsigned(n_vecs * 37 + vecs) ^ Mod);
+    Vec* f[2];
+    Vec* g[2];
+    for (int k = 0; k < 2; ++k) {
+        f[k] = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+        g[k] = ntt::aligned_alloc_array<Vec, 64>(n_vecs);
+    }
+    // Operands of la and lb Vecs: their product fits in la + lb = vecs
+    const std::size_t la = (vecs + 1) / 2, lb = vecs - la;
+    for (std::size_t i = 0; i < n32; ++i) {
+        ((ntt::u32*)f[0])[i] = (i < la * B::LANES) ? rng() % Mod : 0;
+        ((ntt::u32*)g[0])[i] = (i < lb * B::LANES) ? rng() % Mod : 0;
+    }
+    std::memcpy(f[1], f[0], n32 * sizeof(ntt::u32));
+    std::memcpy(g[1], g[0], n32 * sizeof(ntt::u32));
+
+    S::forward(f[0], n_vecs);
+    S::forward(g[0], n_vecs);
+    S::freq_multiply(f[0], g[0], n_vecs);
+    S::inverse(f[0], n_vecs);
+    S::forward(f[1], n_vecs, 1, ~ntt::idt(0), need);
+    S::forward(g[1], n_vecs, 1, ~ntt::idt(0), need);
+    ntt::u32* fu = (ntt::u32*)f[1];
+    for (std::size_t i = need * B::LANES; i < n32; ++i) fu[i] = rng();
+    S::freq_multiply(f[1], g[1], n_vecs, 1, need);
+    for (std::size_t i = need * B::LANES; i < n32; ++i) fu[i] = rng();
+    S::inverse_tft(f[1], n_vecs, need, true);
+
+    bool ok = true;
+    for (std::size_t i = 0; i < need * B::LANES && ok; ++i)
+        if (fu[i] >= 2 * Mod || ((ntt::u32*)f[0])[i] != fu[i] % Mod) {
+            printf("FAIL: differs at %zu\n", i);
+            ok = false;
+        }
+
+    for (int k = 0; k < 2; ++k) {
+        ntt::aligned_free_array(f[k]);
+        ntt::aligned_free_array(g[k]);
+    }
+    if (ok) printf("OK\n");
+    return ok;
+}
+
+#ifdef NTT_HAS_AVX512
+// AVX-512 backend against the AVX2 one (exact product), serial and with
+// the transforms split across threads.
+static bool test_avx512_matches_avx2(std::size_t na, std::size_t nb, unsigned seed) {
+    printf("  avx512 %zu x %zu limbs (seed=%u)... ", na, nb, seed);
+
+    std::mt19937 rng(seed);
+    std::vector<ntt::u32> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+    std::vector<ntt::u32> out2(na + nb), out5(na + nb, 1);
+
+    ntt::big_multiply_with<ntt::Avx2>(out2.data(), out2.size(), a.data(), na, b.data(), nb);
+    ntt::big_multiply_with<ntt::Avx512>(out5.data(), out5.size(), a.data(), na, b.data(), nb);
+    if (out5 != out2) {
+        printf("FAIL: differs from avx2\n");
+        return false;
+    }
+    ntt::set_num_threads(4);
+    std::fill(out5.begin(), out5.end(), 1u);
+    ntt::big_multiply_with<ntt::Avx512>(out5.data(), out5.size(), a.data(), na, b.data(), nb);
+    ntt::set_num_threads(1);
+    if (out5 != out2) {
+        printf("FAIL: threaded differs from avx2\n");
+        return false;
+    }
+
+    printf("OK\n");
+    return true;
+}
+#endif
+
+// Low-memory mode (incremental Garner) against the default mode, also with
+// out overlapping a (r0 cannot be kept in out then) and for squaring.
+static bool test_low_memory(std::size_t na, std::size_t nb, unsigned seed, unsigned threads) {
+    printf("  low-memory %zu x %zu limbs, %u threads (seed=%u)... ", na, nb, threads, seed);
+
+    std::mt19937 rng(seed);
+    std::vector<ntt::u32> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+    std::vector<ntt::u32> ref(na + nb), sq(2 * na), out(na + nb, 1), sq_low(2 * na, 1);
+    ntt::big_multiply(ref.data(), ref.size(), a.data(), na, b.data(), nb);
+    ntt::big_multiply(sq.data(), sq.size(), a.data(), na, a.data(), na);
+
+    ntt::set_num_threads(threads);
+    ntt::set_low_memory(true);
+    ntt::big_multiply(out.data(), out.size(), a.data(), na, b.data(), nb);
+    bool ok = out == ref;
+    // out = a in place
+    std::vector<ntt::u32> io(na + nb);
+    std::copy(a.begin(), a.end(), io.begin());
+    ntt::big_multiply(io.data(), io.size(), io.data(), na, b.data(), nb);
+    ok &= io == ref;
+    ntt::big_multiply(sq_low.data(), sq_low.size(), a.data(), na, a.data(), na);
+    ok &= sq_low == sq;
+    ntt::set_low_memory(false);
+    ntt::set_num_threads(1);
+
+    printf(ok ? "OK\n" : "FAIL: differs from default mode\n");
+    return ok;
+}
+
+// Short products against the full product: big_mullo_u64 exact, and
+// big_mulhi_u64 never above the top n limbs and at most 1 below.  Odd seeds
+// use all-ones operands.
+static bool test_short_products(std::size_t na, std::size_t nb, std::size_t n, unsigned seed) {
+    printf("  mullo/mulhi %zu x %zu limbs, n = %zu (seed=%u)... ", na, nb, n, seed);
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = (seed & 1) ? ~0ULL : rng();
+    for (auto& v : b) v = (seed & 1) ? ~0ULL : rng();
+    std::vector<u64> full(na + nb), lo(n), hi(n);
+    ntt::big_multiply_u64(full.data(), na + nb, a.data(), na, b.data(), nb);
+
+    ntt::big_mullo_u64(lo.data(), n, a.data(), na, b.data(), nb);
+    if (!std::equal(lo.begin(), lo.end(), full.begin())) {
+        printf("FAIL: mullo differs\n");
+        return false;
+    }
+    ntt::big_mulhi_u64(hi.data(), n, a.data(), na, b.data(), nb);
+    // full_hi - hi must be 0 or 1
+    u64 borrow = 0;
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        const u64 x = full[na + nb - n + i], y = hi[i];
+        const u64 dv = x - y - borrow;
+        borrow = (x < y) || (x - y < borrow);
+        if (i == 0 ? dv > 1 : dv != 0) ok = false;
+    }
+    if (!ok || borrow) {
+        printf("FAIL: mulhi off by more than 1\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// big_multiply_narrow (31-bit pieces) against the u32-limb product.  nb == 0
+// squares a; odd seeds use all-ones operands; out_len may cut the product
+// short or run past it.
+static bool test_narrow(std::size_t na, std::size_t nb, std::size_t out_len, unsigned seed) {
+    printf("  narrow %zu x %zu limbs, out_len = %zu (seed=%u)... ", na, nb, out_len, seed);
+
+    std::mt19937_64 rng(seed);
+    const bool sqr = nb == 0;
+    if (sqr) nb = na;
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = (seed & 1) ? ~0ULL : rng();
+    for (auto& v : b) v = (seed & 1) ? ~0ULL : rng();
+    const u64* bp = sqr ? a.data() : b.data();
+
+    std::vector<u64> full(na + nb), out(out_len, 0x5a5a5a5a5a5a5a5aULL);
+    ntt::big_multiply_u64(full.data(), na + nb, a.data(), na, bp, nb);
+    ntt::big_multiply_narrow(out.data(), out_len, a.data(), na, bp, nb);
+    full.resize((std::max)(out_len, na + nb), 0);
+    if (!std::equal(out.begin(), out.end(), full.begin())) {
+        printf("FAIL: differs from big_multiply_u64\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// x[0..n) mod q, for q < 2^64
+static u64 residue_u64(const u64* x, std::size_t n, u64 q) {
+    const u64 r64 = u64(((unsigned __int128)1 << 64) % q);
+    unsigned __int128 r = 0;
+    for (std::size_t i = n; i-- > 0;)
+        r = (u64(r) * (unsigned __int128)r64 + x[i] % q) % q;
+    return u64(r);
+}
+
+// Products at the top of the p30x3 range, past 3*2^23 elements, on both
+// backends: u32 limbs (min(na32, nb32) within P30X3_CRT_LIMIT) or, with
+// narrow, 31-bit pieces (min(na32, nb32) past it).  Too large for a limb by
+// limb reference, so each result is checked mod 2^61 - 1 and 2^64 - 59, and
+// the backends against each other.
+static bool test_large_range(std::size_t na, std::size_t nb, bool narrow, unsigned seed) {
+    printf("  %s %zu x %zu limbs (seed=%u)... ", narrow ? "narrow" : "u32-limb", na, nb, seed);
+    const ntt::idt n32 = ntt::idt(2 * (na + nb));
+    const ntt::idt N = narrow ? ntt::ntt_size_for<ntt::Avx2>(ntt::narrow_len(na) + ntt::narrow_len(nb))
+                              : ntt::ntt_size_for<ntt::Avx2>(n32);
+    const bool past_limit = 2 * std::min(na, nb) > std::size_t(ntt::P30X3_CRT_LIMIT);
+    if (N <= ntt::P30X3_MAX_NTT || N > ntt::P30X3_MAX_NTT_ANY || past_limit != narrow) {
+        printf("FAIL: transform of %zu elements is not in the tested range\n", std::size_t(N));
+        return false;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+    // A run of all-ones limbs for maximal coefficients
+    std::fill(a.begin(), a.begin() + na / 4, ~0ULL);
+    std::fill(b.begin(), b.begin() + nb / 4, ~0ULL);
+
+    const u64 qs[2] = {(u64(1) << 61) - 1, ~u64(0) - 58};
+    u64 expect[2];
+    for (int k = 0; k < 2; ++k) {
+        const unsigned __int128 q = qs[k];
+        expect[k] = u64(residue_u64(a.data(), na, qs[k]) * (unsigned __int128)
+                        residue_u64(b.data(), nb, qs[k]) % q);
+    }
+
+    auto run = [&](std::vector<u64>& out, bool wide) {
+        out.assign(na + nb, 0);
+#ifdef NTT_HAS_AVX512
+        if (wide) {
+            if (narrow)
+                ntt::big_multiply_narrow_with<ntt::Avx512>(out.data(), na + nb, a.data(), na, b.data(), nb);
+            else
+                ntt::big_multiply_with<ntt::Avx512>((u32*)out.data(), n32, (const u32*)a.data(),
+                                                    2 * na, (const u32*)b.data(), 2 * nb);
+            return;
+        }
+#endif
+        (void)wide;
+        if (narrow)
+            ntt::big_multiply_narrow_with<ntt::Avx2>(out.data(), na + nb, a.data(), na, b.data(), nb);
+        else
+            ntt::big_multiply_with<ntt::Avx2>((u32*)out.data(), n32, (const u32*)a.data(),
+                                              2 * na, (const u32*)b.data(), 2 * nb);
+    };
+
+    std::vector<u64> out[2];
+    int backends = 1;
+    run(out[0], false);
+#ifdef NTT_HAS_AVX512
+    if (ntt::cpu_has_avx512f()) {
+        run(out[1], true);
+        backends = 2;
+    }
+#endif
+    for (int w = 0; w < backends; ++w) {
+        for (int k = 0; k < 2; ++k) {
+            if (residue_u64(out[w].data(), na + nb, qs[k]) != expect[k]) {
+                printf("FAIL: %s product wrong mod %llu\n", w ? "AVX-512" : "AVX2",
+                       (unsigned long long)qs[k]);
+                return false;
+            }
+        }
+    }
+    if (backends == 2 && out[0] != out[1]) {
+        printf("FAIL: AVX2 and AVX-512 products differ\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// poly_mul_mod<Mod> against a schoolbook product mod Mod.  nb == 0 squares
+// a; odd seeds use all coefficients Mod - 1.
+template<u32 Mod>
+static bool test_poly_prime(std::size_t na, std::size_t nb, std::size_t out_len, unsigned seed) {
+    printf("  poly mod %u: %zu x %zu, out %zu (seed=%u)... ", Mod, na, nb, out_len, seed);
+
+    std::mt19937 rng(seed);
+    const bool sqr = (nb == 0);
+    std::vector<u32> a(na), b(sqr ? na : nb);
+    for (auto& v : a) v = (seed & 1) ? Mod - 1 : rng() % Mod;
+    for (auto& v : b) v = (seed & 1) ? Mod - 1 : rng() % Mod;
+    if (sqr) b = a;
+
+    std::vector<u64> ref(out_len, 0);
+    for (std::size_t i = 0; i < a.size() && i < out_len; ++i)
+        for (std::size_t j = 0; j < b.size() && i + j < out_len; ++j)
+            ref[i + j] = (ref[i + j] + u64(a[i]) * b[j]) % Mod;
+
+    std::vector<u32> out(out_len, 7);
+    if (sqr) ntt::poly_mul_mod<Mod>(out.data(), out_len, a.data(), na, a.data(), na);
+    else ntt::poly_mul_mod<Mod>(out.data(), out_len, a.data(), na, b.data(), nb);
+    for (std::size_t i = 0; i < out_len; ++i) {
+        if (out[i] != ref[i]) {
+            printf("FAIL at %zu: %u != %llu\n", i, out[i], (unsigned long long)ref[i]);
+            return false;
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+// poly_mul_mod_u64 against a schoolbook product mod `mod`.  nb == 0 squares
+// a; odd seeds use all coefficients mod - 1.
+static bool test_poly_u64(std::size_t na, std::size_t nb, std::size_t out_len, u64 mod,
+                          unsigned seed) {
+    printf("  poly mod %llu: %zu x %zu, out %zu (seed=%u)... ",
+           (unsigned long long)mod, na, nb, out_len, seed);
+
+    std::mt19937_64 rng(seed);
+    const bool sqr = (nb == 0);
+    std::vector<u64> a(na), b(sqr ? na : nb);
+    for (auto& v : a) v = (seed & 1) ? mod - 1 : rng() % mod;
+    for (auto& v : b) v = (seed & 1) ? mod - 1 : rng() % mod;
+    if (sqr) b = a;
+
+    std::vector<u64> ref(out_len, 0);
+    for (std::size_t i = 0; i < a.size() && i < out_len; ++i)
+        for (std::size_t j = 0; j < b.size() && i + j < out_len; ++j)
+            ref[i + j] = ntt::addmod_u64(ref[i + j], ntt::mulmod_u64(a[i], b[j], mod), mod);
+
+    std::vector<u64> out(out_len, 7);
+    if (sqr) ntt::poly_mul_mod_u64(out.data(), out_len, a.data(), na, a.data(), na, mod);
+    else ntt::poly_mul_mod_u64(out.data(), out_len, a.data(), na, b.data(), nb, mod);
+    for (std::size_t i = 0; i < out_len; ++i) {
+        if (out[i] != ref[i]) {
+            printf("FAIL at %zu: %llu != %llu\n", i, (unsigned long long)out[i],
+                   (unsigned long long)ref[i]);
+            return false;
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+// big_multiply_batch over mixed sizes (shared transform lengths, squares,
+// short outputs, empty operands) against one big_multiply_u64 per job.
+static bool test_batch(unsigned threads, unsigned seed) {
+    printf("  batch of mixed products, %u threads (seed=%u)... ", threads, seed);
+
+    std::mt19937_64 rng(seed);
+    const std::size_t sizes[][3] = {   // na, nb, out_len
+        {2000, 2000, 4000}, {2000, 1999, 3999}, {2000, 2000, 4000}, {1, 1, 2},
+        {3000, 500, 3500}, {100, 0, 100}, {5000, 5000, 10000}, {5000, 5000, 700},
+        {2000, 2000, 4000}, {40000, 30000, 70000}, {64, 64, 128}, {2000, 2000, 4000},
+    };
+    const std::size_t count = sizeof(sizes) / sizeof(sizes[0]);
+    std::vector<std::vector<u64>> a(count), b(count), out(count), ref(count);
+    std::vector<ntt::MulJob> jobs(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        a[i].resize(sizes[i][0]);
+        b[i].resize(sizes[i][1]);
+        for (auto& v : a[i]) v = rng();
+        for (auto& v : b[i]) v = rng();
+        out[i].assign(sizes[i][2], 1);
+        ref[i].assign(sizes[i][2], 1);
+        // Job 4 squares
+        const u64* bp = (i == 4) ? a[i].data() : b[i].data();
+        const std::size_t nb = (i == 4) ? sizes[i][0] : sizes[i][1];
+        jobs[i] = {out[i].data(), sizes[i][2], a[i].data(), sizes[i][0], bp, nb};
+        if (sizes[i][0] && nb)
+            ntt::big_multiply_u64(ref[i].data(), sizes[i][2], a[i].data(), sizes[i][0], bp, nb);
+        else
+            std::fill(ref[i].begin(), ref[i].end(), 0);
+    }
+
+    ntt::set_num_threads(threads);
+    ntt::big_multiply_batch(jobs.data(), count);
+    ntt::set_num_threads(1);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (out[i] != ref[i]) {
+            printf("FAIL: job %zu differs\n", i);
+            return false;
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+// Large buffers: 2 MB aligned and counted as advised (or as a fallback)
+// while huge pages are on; untouched by the path when it is off.
+static bool test_huge_pages() {
+    printf("  huge-page buffers... ");
+    const ntt::idt n = ntt::HUGE_PAGE_MIN_BYTES / sizeof(u64) + 1000;
+    const bool was_on = ntt::huge_pages();
+    ntt::set_huge_pages(true);
+    const ntt::HugePageStats s0 = ntt::huge_page_stats();
+    u64* p = ntt::aligned_alloc_array<u64, 64>(n);
+    const ntt::HugePageStats s1 = ntt::huge_page_stats();
+    for (ntt::idt i = 0; i < n; ++i) p[i] = i;
+    const bool aligned = (reinterpret_cast<uintptr_t>(p) & (ntt::HUGE_PAGE_BYTES - 1)) == 0;
+    ntt::aligned_free_array<u64, 64>(p);
+
+    ntt::set_huge_pages(false);
+    p = ntt::aligned_alloc_array<u64, 64>(n);
+    const ntt::HugePageStats s2 = ntt::huge_page_stats();
+    ntt::aligned_free_array<u64, 64>(p);
+    ntt::set_huge_pages(was_on);
+
+    const u64 counted = (s1.advised_buffers - s0.advised_buffers) +
+                        (s1.fallback_buffers - s0.fallback_buffers);
+    const u64 advised = s1.advised_bytes - s0.advised_bytes;
+    if (counted != 1 || (advised != 0 && advised != (n * sizeof(u64) & ~(ntt::HUGE_PAGE_BYTES - 1)))) {
+        printf("FAIL: %llu buffers counted, %llu bytes advised\n",
+               (unsigned long long)counted, (unsigned long long)advised);
+        return false;
+    }
+#if !defined(_MSC_VER)
+    if (!aligned) {
+        printf("FAIL: large buffer not 2 MB aligned\n");
+        return false;
+    }
+#endif
+    if (s2.advised_buffers != s1.advised_buffers || s2.fallback_buffers != s1.fallback_buffers) {
+        printf("FAIL: counted while huge pages are off\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// Scratch arena: large buffers go through the shared depot, so another
+// thread reuses them; the byte cap evicts and arena_trim releases what the
+// calling thread and the depot hold.
+static bool test_arena() {
+    printf("  arena depot, cap and trim... ");
+    ntt::NTTArena& arena = ntt::NTTArena::instance();
+    const ntt::idt big = ntt::idt(1) << 16, small = 64;
+    const size_t big_bytes = big * sizeof(u64);
+    ntt::arena_trim();
+    const ntt::ArenaStats s0 = ntt::arena_stats();
+
+    u64* p = arena.alloc<u64>(big);
+    u64* first = ntt::NTTArena::raw(p);
+    arena.dealloc(p, big);
+    const ntt::ArenaStats s1 = ntt::arena_stats();
+
+    u64* other = nullptr;
+    std::thread([&] {
+        ntt::NTTArena& a = ntt::NTTArena::instance();
+        u64* q = a.alloc<u64>(big);
+        other = ntt::NTTArena::raw(q);
+        a.dealloc(q, big);
+    }).join();
+    const ntt::ArenaStats s2 = ntt::arena_stats();
+
+    u64* q = arena.alloc<u64>(small);
+    arena.dealloc(q, small);
+    const size_t cap = ntt::arena_cap();
+    ntt::set_arena_cap(0);
+    const ntt::ArenaStats s3 = ntt::arena_stats();
+    ntt::set_arena_cap(cap);
+    ntt::arena_trim();
+    const ntt::ArenaStats s4 = ntt::arena_stats();
+
+    if (s1.misses != s0.misses + 1 || s1.bytes_held != s0.bytes_held + big_bytes ||
+        s1.peak_bytes < s0.bytes_held + big_bytes) {
+        printf("FAIL: first allocation not counted\n");
+        return false;
+    }
+    if (other != first || s2.hits != s1.hits + 1 || s2.misses != s1.misses) {
+        printf("FAIL: depot buffer not reused by another thread\n");
+        return false;
+    }
+    if (s3.evictions == s2.evictions || s3.bytes_held != s2.bytes_held - big_bytes + small * sizeof(u64)) {
+        printf("FAIL: cap 0 did not evict the depot (%llu bytes held)\n",
+               (unsigned long long)s3.bytes_held);
+        return false;
+    }
+    if (s4.bytes_held != s0.bytes_held || s4.bytes_in_use != s0.bytes_in_use) {
+        printf("FAIL: trim left %llu bytes held, %llu in use\n",
+               (unsigned long long)s4.bytes_held, (unsigned long long)s4.bytes_in_use);
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// warmup(n) leaves every scratch buffer of an n x n product cached, so the
+// product that follows allocates nothing; num_threads() is restored.
+static bool test_warmup(std::size_t n, unsigned threads, unsigned seed) {
+    printf("  warmup(%zu, %u) then %zu x %zu (seed=%u)... ", n, threads, n, n, seed);
+    ntt::arena_trim();
+    const unsigned saved = ntt::num_threads();
+    ntt::warmup(n, threads);
+    if (ntt::num_threads() != saved) {
+        printf("FAIL: num_threads %u after warmup, was %u\n", ntt::num_threads(), saved);
+        return false;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(n), b(n), out(2 * n), ref(2 * n);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+    const ntt::ArenaStats s0 = ntt::arena_stats();
+    ntt::big_multiply_u64(out.data(), 2 * n, a.data(), n, b.data(), n);
+    const ntt::ArenaStats s1 = ntt::arena_stats();
+    schoolbook_mul(ref.data(), 2 * n, a.data(), n, b.data(), n);
+    if (out != ref) {
+        printf("FAIL: product differs from schoolbook\n");
+        return false;
+    }
+    if (s1.misses != s0.misses || s1.hits == s0.hits) {
+        printf("FAIL: %llu fresh allocations after warmup\n",
+               (unsigned long long)(s1.misses - s0.misses));
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// Profiling: a capture sees one product, including the primes its pool
+// threads transform, and leaves the global counters alone while profiling
+// is off; with it on, the per-thread counters of exited threads are kept.
+// Hardware counts appear exactly when perf_event_open works here.
+static bool test_profile(unsigned seed) {
+    printf("  profile capture and per-thread counters (seed=%u)... ", seed);
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(40000), b(40000), out(80000);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+
+    ntt::profile_set_enabled(false);
+    ntt::profile_reset();
+    ntt::set_num_threads(3);
+    ntt::ProfileCounters c;
+    {
+        ntt::ProfileCapture cap;
+        ntt::big_multiply_u64(out.data(), out.size(), a.data(), a.size(), b.data(), b.size());
+        c = cap.counters();
+    }
+    ntt::set_num_threads(1);
+    if (c.calls[ntt::PROF_API_TOTAL] != 1 || c.calls[ntt::PROF_API_FORWARD] != 3 ||
+        c.calls[ntt::PROF_API_INVERSE] != 3 || c.ns[ntt::PROF_API_TOTAL] == 0) {
+        printf("FAIL: capture counted %llu products, %llu forward\n",
+               (unsigned long long)c.calls[ntt::PROF_API_TOTAL],
+               (unsigned long long)c.calls[ntt::PROF_API_FORWARD]);
+        return false;
+    }
+    if (ntt::profile_counters().calls[ntt::PROF_API_TOTAL] != 0) {
+        printf("FAIL: capture leaked into the global counters\n");
+        return false;
+    }
+
+    {
+        ntt::ProfileCapture cap;
+        ntt::p50x4::Ntt4::instance().multiply(out.data(), out.size(),
+                                              a.data(), 3000, b.data(), 2000);
+        c = cap.counters();
+    }
+    if (c.calls[ntt::PROF_P50X4_TOTAL] != 1 || c.calls[ntt::PROF_P50X4_FORWARD] != 4 ||
+        c.calls[ntt::PROF_P50X4_CRT] != 1) {
+        printf("FAIL: p50x4 capture counted %llu products\n",
+               (unsigned long long)c.calls[ntt::PROF_P50X4_TOTAL]);
+        return false;
+    }
+
+    // Hardware counters where the PMU is reachable, wall time only elsewhere
+    ntt::profile_set_hw(true);
+    {
+        ntt::ProfileCapture cap;
+        ntt::big_multiply_u64(out.data(), 4000, a.data(), 2000, b.data(), 2000);
+        c = cap.counters();
+    }
+    ntt::profile_set_hw(false);
+    const u64 cycles = c.hw[ntt::PROF_API_TOTAL][ntt::PROF_HW_CYCLES];
+    if (c.calls[ntt::PROF_API_TOTAL] != 1 || (cycles != 0) != ntt::profile_hw_available()) {
+        printf("FAIL: %llu cycles counted, counters %savailable\n",
+               (unsigned long long)cycles, ntt::profile_hw_available() ? "" : "not ");
+        return false;
+    }
+
+    ntt::profile_set_enabled(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t)
+        threads.emplace_back([&, t] {
+            std::vector<u64> r(4000);
+            for (int rep = 0; rep <= t; ++rep)
+                ntt::big_multiply_u64(r.data(), r.size(), a.data(), 2000, b.data(), 2000);
+        });
+    for (auto& th : threads) th.join();
+    ntt::profile_set_enabled(false);
+    const u64 total = ntt::profile_counters().calls[ntt::PROF_API_TOTAL];
+    ntt::profile_reset();
+    if (total != 6 || ntt::profile_counters().calls[ntt::PROF_API_TOTAL] != 0) {
+        printf("FAIL: %llu products counted over 3 threads, expected 6\n",
+               (unsigned long long)total);
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// big_dot against the products summed one by one.  ones: all operand limbs
+// 2^64 - 1, the largest coefficients the CRT budget has to cover.
+static bool test_dot(const std::vector<std::pair<std::size_t, std::size_t>>& shapes,
+                     bool ones, unsigned seed) {
+    printf("  dot of %zu terms%s (seed=%u)... ", shapes.size(), ones ? ", all ones" : "", seed);
+
+    std::mt19937_64 rng(seed);
+    const std::size_t count = shapes.size();
+    std::vector<std::vector<u64>> a(count), b(count);
+    std::vector<ntt::DotTerm> terms(count);
+    std::size_t out_len = 1;
+    for (std::size_t i = 0; i < count; ++i) {
+        a[i].resize(shapes[i].first);
+        b[i].resize(shapes[i].second);
+        for (auto& v : a[i]) v = ones ? ~0ULL : rng();
+        for (auto& v : b[i]) v = ones ? ~0ULL : rng();
+        // Every third term squares
+        const bool sqr = (i % 3 == 2);
+        terms[i] = {a[i].data(), a[i].size(), sqr ? a[i].data() : b[i].data(),
+                    sqr ? a[i].size() : b[i].size()};
+        out_len = std::max(out_len, terms[i].na + terms[i].nb + 1);
+    }
+
+    std::vector<u64> ref(out_len, 0), prod(out_len);
+    for (const auto& t : terms) {
+        if (!t.na || !t.nb) continue;
+        ntt::big_multiply_u64(prod.data(), t.na + t.nb, t.a, t.na, t.b, t.nb);
+        ntt::add_into_u64(ref.data(), out_len, prod.data(), t.na + t.nb);
+    }
+    std::vector<u64> out(out_len, 1);
+    ntt::big_dot(out.data(), out_len, terms.data(), count);
+    if (out != ref) {
+        printf("FAIL: differs from the summed products\n");
+        return false;
+    }
+    // Truncated output
+    std::vector<u64> lo(out_len / 2 + 1, 1);
+    ntt::big_dot(lo.data(), lo.size(), terms.data(), count);
+    if (!std::equal(lo.begin(), lo.end(), ref.begin())) {
+        printf("FAIL: truncated sum differs\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// PreparedOperand: several right operands against one cached A, each
+// compared with a plain big_multiply_u64 (also checks A is not modified).
+static bool test_prepared(std::size_t na, std::size_t max_nb, unsigned seed) {
+    printf("  prepared %zu x (<=%zu) limbs (seed=%u)... ", na, max_nb, seed);
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na);
+    for (auto& v : a) v = rng();
+    ntt::PreparedOperand pa(a.data(), na, max_nb);
+
+    for (std::size_t nb : {max_nb, max_nb / 2 + 1, std::size_t(1), max_nb}) {
+        std::vector<u64> b(nb);
+        for (auto& v : b) v = rng();
+        std::vector<u64> out_p(na + nb, 1), out_ref(na + nb, 0);
+        ntt::multiply(out_p.data(), out_p.size(), pa, b.data(), nb);
+        ntt::big_multiply_u64(out_ref.data(), out_ref.size(), a.data(), na, b.data(), nb);
+        if (out_p != out_ref) {
+            printf("FAIL: nb=%zu differs from big_multiply_u64\n", nb);
+            return false;
+        }
+    }
+
+    // A right operand past max_nb must be rejected, not overrun the buffers
+    std::vector<u64> b(max_nb + 1, 1), out(na + max_nb + 1);
+    try {
+        ntt::multiply(out.data(), out.size(), pa, b.data(), b.size());
+        printf("FAIL: nb=%zu > max_nb accepted\n", b.size());
+        return false;
+    } catch (const std::length_error&) {
+    }
+
+    printf("OK\n");
+    return true;
+}
+
+// Same for the p50x4 engine, driven directly (the public dispatcher only
+// uses it past the reach of the p30x3 primes).
+static bool test_prepared_p50x4(std::size_t na, std::size_t nb, unsigned seed) {
+    printf("  p50x4 prepared %zu x %zu limbs (seed=%u)... ", na, nb, seed);
+    using namespace ntt::p50x4;
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+
+    Ntt4& eng = Ntt4::instance();
+    std::size_t N = Ntt4::transform_size(na, nb);
+    double* fa[4];
+    for (auto& p : fa) p = alloc_doubles(N);
+    eng.prepare(fa, N, a.data(), na);
+
+    std::vector<u64> out_p(na + nb), out_ref(na + nb);
+    eng.multiply(out_ref.data(), out_ref.size(), a.data(), na, b.data(), nb);
+    bool ok = true;
+    for (int rep = 0; rep < 2 && ok; ++rep) {
+        eng.multiply_prepared(out_p.data(), out_p.size(), fa, na, N, b.data(), nb);
+        ok = (out_p == out_ref);
+    }
+    for (auto& p : fa) free_doubles(p);
+
+    printf(ok ? "OK\n" : "FAIL: differs from Ntt4::multiply\n");
+    return ok;
+}
+
+// Ntt4::multiply against schoolbook for full, longer (zero-filled) and
+// truncated outputs, and squaring.  The transform buffers come back from the
+// arena dirty after the first product.
+static bool test_p50x4(std::size_t na, std::size_t nb, unsigned seed) {
+    printf("  p50x4 %zu x %zu limbs (seed=%u)... ", na, nb, seed);
+    ntt::p50x4::Ntt4& eng = ntt::p50x4::Ntt4::instance();
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+
+    for (int sqr = 0; sqr < 2; ++sqr) {
+        const u64* bp = sqr ? a.data() : b.data();
+        const std::size_t bn = sqr ? na : nb;
+        for (std::size_t out_len : {na + bn, na + bn + 3, (na + bn) / 2}) {
+            std::vector<u64> out(out_len, ~u64(0)), ref(out_len);
+            eng.multiply(out.data(), out_len, a.data(), na, bp, bn);
+            schoolbook_mul(ref.data(), out_len, a.data(), na, bp, bn);
+            if (out != ref) {
+                printf("FAIL: %s, out_len %zu\n", sqr ? "square" : "product", out_len);
+                return false;
+            }
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+// The four p50x4 primes on pool threads (product, square, prepared) must
+// match the sequential engine bit for bit.
+static bool test_p50x4_parallel(std::size_t na, std::size_t nb, unsigned threads, unsigned seed) {
+    printf("  p50x4 parallel primes %zu x %zu limbs, %u threads (seed=%u)... ",
+           na, nb, threads, seed);
+    using namespace ntt::p50x4;
+    Ntt4& eng = Ntt4::instance();
+    const std::size_t N = Ntt4::transform_size(na, nb);
+    if (N < Ntt4::PARALLEL_PRIMES_MIN_N) {
+        printf("FAIL: transform of %zu stays sequential\n", N);
+        return false;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::vector<u64> a(na), b(nb);
+    for (auto& v : a) v = rng();
+    for (auto& v : b) v = rng();
+
+    std::vector<u64> out[2][3];
+    double* fa[4];
+    for (auto& p : fa) p = alloc_doubles(N);
+    for (int par = 0; par < 2; ++par) {
+        ntt::set_num_threads(par ? threads : 1);
+        auto& o = out[par];
+        o[0].resize(na + nb);
+        o[1].resize(2 * na);
+        o[2].resize(na + nb);
+        eng.multiply(o[0].data(), o[0].size(), a.data(), na, b.data(), nb);
+        eng.multiply(o[1].data(), o[1].size(), a.data(), na, a.data(), na);
+        eng.prepare(fa, N, a.data(), na);
+        eng.multiply_prepared(o[2].data(), o[2].size(), fa, na, N, b.data(), nb);
+    }
+    ntt::set_num_threads(1);
+    for (auto& p : fa) free_doubles(p);
+
+    static const char* what[3] = {"product", "square", "prepared product"};
+    for (int k = 0; k < 3; ++k) {
+        if (out[0][k] != out[1][k]) {
+            printf("FAIL: parallel %s differs\n", what[k]);
+            return false;
+        }
+    }
+    if (out[0][0] != out[0][2]) {
+        printf("FAIL: prepared product differs from product\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+// Bailey 4-step split over pool threads against the single-thread run, for
+// the forward transform and the round trip (equal mod p; the parallel
+// twiddle chains start from powers, so representatives may differ).
+static bool test_bailey_parallel(int L, unsigned threads, unsigned seed) {
+    printf("  p50x4 Bailey 2^%d on %u threads (seed=%u)... ", L, threads, seed);
+    using namespace ntt::p50x4;
+    FftCtx Q;
+    Q.init(PRIMES[1]);
+    const std::size_t N = std::size_t(1) << L;
+
+    std::mt19937_64 rng(seed);
+    std::vector<double> x(N);
+    for (auto& v : x) v = s_reduce_0n_to_pmhn(double(rng() % Q.prime), Q.p);
+
+    auto canon = [&](double v) {
+        const long long m = (long long)Q.prime, r = (long long)v % m;
+        return r < 0 ? r + m : r;
+    };
+    double* d[2][2];
+    for (int par = 0; par < 2; ++par) {
+        ntt::set_num_threads(par ? threads : 1);
+        for (int inv = 0; inv < 2; ++inv) {
+            d[par][inv] = alloc_doubles(N);
+            std::memcpy(d[par][inv], x.data(), N * sizeof(double));
+            fft_bailey(Q, d[par][inv], L);
+            if (inv) ifft_bailey(Q, d[par][inv], L);
+        }
+    }
+    ntt::set_num_threads(1);
+
+    bool ok = true;
+    for (int inv = 0; inv < 2 && ok; ++inv)
+        for (std::size_t i = 0; i < N && ok; ++i)
+            ok = canon(d[0][inv][i]) == canon(d[1][inv][i]);
+    // The round trip is N times the input
+    const double n_mod = s_reduce_0n_to_pmhn(double(N % Q.prime), Q.p);
+    for (std::size_t i = 0; i < N && ok; i += 97)
+        ok = canon(d[1][1][i]) == canon(s_mulmod(x[i], n_mod, Q.p, Q.pinv));
+    for (auto& row : d)
+        for (double* p : row) free_doubles(p);
+    Q.clear();
+
+    printf(ok ? "OK\n" : "FAIL: parallel Bailey differs\n");
+    return ok;
+}
+
+// An exception thrown by a parallel_for body (on a worker or the caller)
+// reaches the caller once every thread has left the job, and the pool
+// keeps working afterwards.
+static bool test_pool_exception(unsigned threads) {
+    printf("  thread pool exception, %u threads... ", threads);
+    ntt::ThreadPool& pool = ntt::ThreadPool::instance();
+    for (ntt::idt bad : {ntt::idt(0), ntt::idt(5), ntt::idt(63)}) {
+        try {
+            pool.parallel_for(64, threads, [&](ntt::idt i) {
+                if (i == bad) throw std::runtime_error("body");
+            });
+            printf("FAIL: exception from index %zu lost\n", std::size_t(bad));
+            return false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    std::atomic<ntt::idt> sum{0};
+    pool.parallel_for(100, threads, [&](ntt::idt i) { sum.fetch_add(i); });
+    if (sum.load() != 4950) {
+        printf("FAIL: pool broken after exception\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
 int main() {
     printf("=== ntt::big_multiply_u64 integration tests ===\n\n");
 
@@ -141,6 +1182,163 @@ int main() {
     // Larger sizes (still small enough for schoolbook in reasonable time)
     all_pass &= test_vs_schoolbook(500, 500, 10);
     all_pass &= test_vs_schoolbook(1000, 1000, 11);
+    // Truncated 2^12 transforms (products between 6*2^9 and 7*2^9)
+    all_pass &= test_vs_schoolbook(850, 850, 35);
+    all_pass &= test_vs_schoolbook(1690, 11, 36);
+
+    // Prepared operands
+    all_pass &= test_prepared(1, 1, 16);
+    all_pass &= test_prepared(300, 700, 17);
+    all_pass &= test_prepared(5000, 5000, 18);
+    all_pass &= test_p50x4(1500, 1300, 21);
+    all_pass &= test_p50x4(37, 2000, 22);
+    all_pass &= test_prepared_p50x4(700, 900, 19);
+    all_pass &= test_p50x4_parallel(40000, 41000, 4, 23);
+    all_pass &= test_p50x4_parallel(90000, 100, 3, 24);
+    all_pass &= test_bailey_parallel(16, 3, 25);
+    all_pass &= test_bailey_parallel(19, 4, 26);
+    all_pass &= test_pool_exception(4);
+    all_pass &= test_prepared_p50x4(4000, 123, 20);
+
+    // Threaded transforms: even/odd log2, radix-3, radix-5 and radix-15 outer
+    // passes
+    all_pass &= test_parallel_transform<ntt::CRT_P0>(1 << 14, 4);
+    all_pass &= test_parallel_transform<ntt::CRT_P1>(1 << 15, 3);
+    all_pass &= test_parallel_transform<ntt::CRT_P2>(3 << 13, 4);
+    all_pass &= test_parallel_transform<ntt::CRT_P0>(5 << 13, 8);
+    all_pass &= test_parallel_transform<ntt::CRT_P1>(1 << 18, 2);
+    all_pass &= test_parallel_transform<ntt::CRT_P2>(15 << 10, 4);
+
+    // Vector CRT: block multiples, tails, streaming stores
+    all_pass &= test_crt_vector(1, 31);
+    all_pass &= test_crt_vector(64, 32);
+    all_pass &= test_crt_vector(1000, 33);
+    all_pass &= test_crt_vector((1 << 20) + 37, 34);
+
+    all_pass &= test_reduce_and_pad3(0, 41);
+    all_pass &= test_reduce_and_pad3(5, 42);
+    all_pass &= test_reduce_and_pad3(24, 43);
+    all_pass &= test_reduce_and_pad3(1001, 44);
+
+    // Pruned transforms: odd/even log2, radix-3/5/15, lengths on and off the
+    // row boundaries of the top stage
+    all_pass &= test_pruned_transform<ntt::CRT_P0>(1 << 10, 300, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P1>(1 << 11, 1024, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P2>(1 << 11, 1500, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P0>(3 << 9, 700, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P1>(5 << 9, 1100, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P2>(5 << 9, 1, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P0>(8, 3, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P1>(1 << 14, 5000, 4);
+    all_pass &= test_pruned_transform<ntt::CRT_P2>(1 << 15, 20000, 3);
+    all_pass &= test_pruned_transform<ntt::CRT_P0>(5 << 13, 17000, 8);
+    all_pass &= test_pruned_transform<ntt::CRT_P0>(15 << 8, 2000, 1);
+    all_pass &= test_pruned_transform<ntt::CRT_P1>(15 << 11, 20000, 3);
+
+    // Truncated transforms: even/odd log2, products past and below half the
+    // transform (down to a few grains), up to the 7/8 cut-off
+    all_pass &= test_truncated_transform<ntt::CRT_P0>(1 << 10, 600);
+    all_pass &= test_truncated_transform<ntt::CRT_P1>(1 << 11, 1100);
+    all_pass &= test_truncated_transform<ntt::CRT_P2>(1 << 11, 1500);
+    all_pass &= test_truncated_transform<ntt::CRT_P0>(1 << 13, 100);
+    all_pass &= test_truncated_transform<ntt::CRT_P1>(1 << 12, 3500);
+    all_pass &= test_truncated_transform<ntt::CRT_P2>(1 << 15, 21000);
+    all_pass &= test_truncated_transform<ntt::CRT_P0>(1 << 16, 40000);
+
+#ifdef NTT_HAS_AVX512
+    // AVX-512 backend: power-of-2 (also truncated), radix-3 and radix-5
+    // sizes, small and threaded transforms
+    if (ntt::cpu_has_avx512f()) {
+        all_pass &= test_avx512_matches_avx2(1, 1, 22);
+        all_pass &= test_avx512_matches_avx2(100, 60, 23);
+        all_pass &= test_avx512_matches_avx2(1000, 1000, 24);
+        all_pass &= test_avx512_matches_avx2(1500, 1400, 30);
+        all_pass &= test_avx512_matches_avx2(2500, 2300, 25);
+        all_pass &= test_avx512_matches_avx2(3400, 3300, 31);
+        all_pass &= test_avx512_matches_avx2(4000, 3000, 26);
+        all_pass &= test_avx512_matches_avx2(150000, 90000, 27);
+        all_pass &= test_avx512_matches_avx2(300000, 310000, 28);
+        all_pass &= test_avx512_matches_avx2(600000, 600000, 29);
+    }
+#endif
+
+    // Low-memory mode: Garner tails (odd lengths), radix-3/5, threaded
+    all_pass &= test_low_memory(1, 1, 51, 1);
+    all_pass &= test_low_memory(1000, 777, 52, 1);
+    all_pass &= test_low_memory(3001, 2999, 53, 1);
+    all_pass &= test_low_memory(100000, 60001, 54, 4);
+
+    // Short products: balanced, unbalanced (operands truncated), n past the
+    // shorter operand, all-ones operands (odd seeds)
+    all_pass &= test_short_products(1, 1, 1, 61);
+    all_pass &= test_short_products(1000, 1000, 1000, 62);
+    all_pass &= test_short_products(1000, 1000, 1000, 63);
+    all_pass &= test_short_products(5000, 300, 700, 64);
+    all_pass &= test_short_products(300, 5000, 200, 65);
+    all_pass &= test_short_products(4000, 3000, 6999, 66);
+    all_pass &= test_short_products(20000, 20000, 3, 67);
+    // Lengths that run cyclically below na + nb (AVX2, then AVX-512 sizes)
+    all_pass &= test_short_products(700, 700, 700, 68);
+    all_pass &= test_short_products(900, 900, 900, 69);
+    all_pass &= test_short_products(100000, 100000, 100000, 70);
+    all_pass &= test_short_products(200000, 150000, 180000, 71);
+
+    // Narrow-coefficient products: block tails, squaring, truncated and
+    // padded outputs, all-ones operands (odd seeds)
+    all_pass &= test_narrow(1, 1, 2, 101);
+    all_pass &= test_narrow(31, 17, 48, 102);
+    all_pass &= test_narrow(1000, 0, 2000, 103);
+    all_pass &= test_narrow(3000, 2500, 1777, 104);
+    all_pass &= test_narrow(5000, 7000, 12005, 105);
+    all_pass &= test_narrow(20000, 300, 20300, 106);
+
+    // Past 3*2^23 elements: the 2^25 and 7.5*2^22 transforms with u32 limbs
+    // and 31-bit pieces, 5*2^23 and 3*2^24 (the largest) with pieces
+    all_pass &= test_large_range(10000000, 6000000, false, 107);
+    all_pass &= test_large_range(7000000, 7000000, true, 108);
+    all_pass &= test_large_range(9500000, 9500000, true, 109);
+    all_pass &= test_large_range(12000000, 11500000, true, 110);
+
+    // Polynomial products: one prime, and any u64 modulus via CRT
+    all_pass &= test_poly_prime<ntt::CRT_P0>(1, 1, 1, 71);
+    all_pass &= test_poly_prime<ntt::CRT_P0>(300, 200, 499, 72);
+    all_pass &= test_poly_prime<ntt::CRT_P1>(1000, 0, 1999, 73);
+    all_pass &= test_poly_prime<ntt::CRT_P2>(3000, 2500, 1200, 74);
+    all_pass &= test_poly_prime<ntt::CRT_P2>(40, 70, 200, 75);
+    all_pass &= test_poly_u64(1, 1, 1, 998244353, 81);
+    all_pass &= test_poly_u64(500, 400, 899, 998244353, 82);
+    all_pass &= test_poly_u64(2000, 1500, 3499, u64(1) << 32, 83);
+    all_pass &= test_poly_u64(700, 0, 1399, (u64(1) << 61) - 1, 84);
+    all_pass &= test_poly_u64(3000, 2000, 4999, ~u64(0) - 58, 85);
+    all_pass &= test_poly_u64(2500, 0, 4999, ~u64(0) - 58, 86);
+    all_pass &= test_poly_u64(1000, 3000, 1500, 1000000007, 87);
+
+    // Parallel prime mode (above PARALLEL_PRIMES_MIN_NTT)
+    all_pass &= test_parallel_matches_serial(20000, 20000, 12);
+    all_pass &= test_parallel_matches_serial(40000, 3000, 13);
+    all_pass &= test_parallel_matches_serial(30000, 0, 14);
+    all_pass &= test_dot({{1, 1}, {3000, 2000}, {5, 0}, {2500, 2600}, {100, 7000}}, false, 93);
+    all_pass &= test_dot({{64, 64}, {64, 64}, {64, 64}}, true, 94);
+    // One large term among small ones: separate transform-size buckets
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> mixed(30, {40, 70});
+        mixed[7] = {30000, 25000};
+        mixed[20] = {900, 1000};
+        all_pass &= test_dot(mixed, false, 98);
+    }
+    // 10 * 1.4M u32 limbs passes DOT_CRT_BUDGET: two groups
+    all_pass &= test_dot(std::vector<std::pair<std::size_t, std::size_t>>(10, {700000, 700000}),
+                         true, 95);
+    all_pass &= test_batch(1, 91);
+    all_pass &= test_batch(4, 92);
+    all_pass &= test_profile(96);
+    all_pass &= test_huge_pages();
+    all_pass &= test_arena();
+    all_pass &= test_warmup(3000, 2, 97);
+    ntt::set_num_threads(12);
+    all_pass &= test_vs_schoolbook(20000, 20000, 15);
+    all_pass &= test_prepared(30000, 20000, 21);
+    ntt::set_num_threads(1);
 
     printf("\n%s\n", all_pass ? "ALL TESTS PASSED" : "SOME TESTS FAILED");
     return all_pass ? 0 : 1;
@@ -0,0 +1,223 @@
+// tune_bigint.cpp - Measure the bi:: crossover thresholds on this machine
+//
+//   g++ -O2 -march=native -std=c++17 -I. tune_bigint.cpp -o tune_bigint
+//   ./tune_bigint > bigint/tuning_local.hpp
+//
+// Progress goes to stderr and the generated header to stdout.  bigint/
+// tuning.hpp picks the header up, so everything built afterwards uses the
+// measured thresholds.  Build the tuner with the flags the library is used
+// with; the crossovers depend on them (-march, AVX-512).
+//
+// Each threshold is found by timing the two algorithms it chooses between on
+// the sizes around it, with the thresholds set so that exactly one level of
+// the faster-asymptotic algorithm runs above the slower one (as in GMP's
+// tuneup).  The crossover is the first size from which the new algorithm
+// wins three measurements in a row.  Thresholds are tuned in dependency
+// order: Karatsuba before NTT, multiplication before division, division
+// before radix conversion.
+//
+// P30X3_MAX_NTT is not tuned: it is the largest transform whose products stay
+// below the three-prime CRT bound, a correctness limit rather than a
+// crossover (ntt/api.hpp picks p30x3 vs p50x4 by cost model above it).
+#define BI_TUNE_PROGRAM
+#include "bigint/bigint.hpp"
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+
+using bi::bigint;
+using bi::limb_t;
+
+static constexpr uint32_t NEVER = ~uint32_t(0);
+
+static double now_ns() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Best-of-5 time per call in ns; each sample runs f for at least 2 ms.
+template<typename F>
+static double time_ns(F&& f) {
+    f();
+    double best = 1e300;
+    for (int rep = 0; rep < 5; rep++) {
+        int iters = 0;
+        double t0 = now_ns(), t1;
+        do {
+            f();
+            iters++;
+            t1 = now_ns();
+        } while (t1 - t0 < 2e6);
+        double t = (t1 - t0) / iters;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+static std::mt19937_64 rng(12345);
+
+static void random_limbs(std::vector<limb_t>& v, uint32_t n) {
+    v.resize(n);
+    for (uint32_t i = 0; i < n; i++) v[i] = rng();
+    if (n) v[n - 1] |= limb_t(1) << 63;   // full length, normalized
+}
+
+// Sizes lo, lo * step, ... (at least +1 each), up to hi.
+static std::vector<uint32_t> size_range(uint32_t lo, uint32_t hi, double step) {
+    std::vector<uint32_t> sizes;
+    for (double x = lo; x <= hi;) {
+        uint32_t n = (uint32_t)x;
+        sizes.push_back(n);
+        x = (x * step > n + 1) ? x * step : n + 1;
+    }
+    return sizes;
+}
+
+// First size n in [lo, hi] from which run(n) with use(n, true) beats run(n)
+// with use(n, false) three times in a row; NEVER if it does not happen.
+template<typename Use, typename Run>
+static uint32_t crossover(const char* name, uint32_t lo, uint32_t hi, double step,
+                          Use&& use, Run&& run) {
+    fprintf(stderr, "%s\n", name);
+    uint32_t first = NEVER;
+    int wins = 0;
+    for (uint32_t n : size_range(lo, hi, step)) {
+        use(n, false);
+        double t_old = time_ns([&] { run(n); });
+        use(n, true);
+        double t_new = time_ns([&] { run(n); });
+        fprintf(stderr, "  %6u: %12.0f ns %12.0f ns  %.3f\n", n, t_old, t_new, t_new / t_old);
+        if (t_new < t_old) {
+            if (wins++ == 0) first = n;
+            if (wins == 3) return first;
+        } else {
+            wins = 0;
+            first = NEVER;
+        }
+    }
+    return first;
+}
+
+struct Result {
+    const char* macro;
+    uint32_t value;
+};
+
+int main() {
+    std::vector<Result> results;
+    std::vector<limb_t> a, b, r, q, np;
+
+    // Measured with everything above off, then fixed before the next one.
+    bi::NTT_THRESHOLD = bi::SQR_NTT_THRESHOLD = NEVER;
+    bi::MULMOD_BNM1_THRESHOLD = NEVER;
+
+    auto keep = [&](const char* macro, uint32_t& thr, uint32_t value, uint32_t lo, uint32_t hi) {
+        if (value == NEVER) {
+            fprintf(stderr, "  no crossover up to %u, using %u\n", hi, hi);
+            value = hi;
+        }
+        if (value < lo) value = lo;
+        thr = value;
+        results.push_back({macro, value});
+        fprintf(stderr, "%s = %u\n\n", macro, value);
+    };
+
+    // ---- Multiplication ----
+
+    auto mul = [&](uint32_t n) { bi::mpn_mul(r.data(), a.data(), n, b.data(), n); };
+    auto sqr = [&](uint32_t n) { bi::mpn_sqr(r.data(), a.data(), n); };
+    auto operands = [&](uint32_t n) {
+        if (a.size() != n) { random_limbs(a, n); random_limbs(b, n); r.resize(2 * n); }
+    };
+
+    uint32_t t = crossover("KARATSUBA_THRESHOLD", 4, 200, 1.05,
+        [&](uint32_t n, bool on) { operands(n); bi::KARATSUBA_THRESHOLD = on ? n : NEVER; }, mul);
+    keep("BI_KARATSUBA_THRESHOLD", bi::KARATSUBA_THRESHOLD, t, 4, 200);
+
+    t = crossover("SQR_KARATSUBA_THRESHOLD", 4, 200, 1.05,
+        [&](uint32_t n, bool on) { operands(n); bi::SQR_KARATSUBA_THRESHOLD = on ? n : NEVER; }, sqr);
+    keep("BI_SQR_KARATSUBA_THRESHOLD", bi::SQR_KARATSUBA_THRESHOLD, t, 4, 200);
+
+    t = crossover("NTT_THRESHOLD", 64, 16384, 1.1,
+        [&](uint32_t n, bool on) { operands(n); bi::NTT_THRESHOLD = on ? n : NEVER; }, mul);
+    keep("BI_NTT_THRESHOLD", bi::NTT_THRESHOLD, t, 64, 16384);
+
+    t = crossover("SQR_NTT_THRESHOLD", 64, 16384, 1.1,
+        [&](uint32_t n, bool on) { operands(n); bi::SQR_NTT_THRESHOLD = on ? n : NEVER; }, sqr);
+    keep("BI_SQR_NTT_THRESHOLD", bi::SQR_NTT_THRESHOLD, t, 64, 16384);
+
+    // rn-limb wraparound products of rn-limb operands, at the sizes Newton
+    // division asks for (mpn_mulmod_bnm1_next_size above the threshold)
+    auto bnm1_size = [](uint32_t n) { return (uint32_t)ntt::mulmod_bnm1_size((ntt::idt)n); };
+    t = crossover("MULMOD_BNM1_THRESHOLD", 16, 16384, 1.1,
+        [&](uint32_t n, bool on) {
+            operands(bnm1_size(n));
+            bi::MULMOD_BNM1_THRESHOLD = on ? n : NEVER;
+        },
+        [&](uint32_t n) {
+            uint32_t rn = bnm1_size(n);
+            bi::mpn_mulmod_bnm1(r.data(), rn, a.data(), rn, b.data(), rn);
+        });
+    keep("BI_MULMOD_BNM1_THRESHOLD", bi::MULMOD_BNM1_THRESHOLD, t, 16, 16384);
+
+    // ---- Division ----
+
+    // One Newton step on top of the schoolbook base case
+    t = crossover("INVERT_THRESHOLD", 4, 400, 1.05,
+        [&](uint32_t n, bool on) {
+            if (b.size() != n) { random_limbs(b, n); r.resize(n); }
+            bi::INVERT_THRESHOLD = on ? n - 1 : NEVER;
+        },
+        [&](uint32_t n) { bi::mpn_newton_invert(r.data(), b.data(), n); });
+    keep("BI_INVERT_THRESHOLD", bi::INVERT_THRESHOLD, t == NEVER ? t : t - 1, 1, 400);
+
+    // 2n / n limbs; the copy of the numerator is in both timings
+    t = crossover("DIV_DC_THRESHOLD", 8, 1000, 1.05,
+        [&](uint32_t n, bool on) {
+            if (a.size() != 2 * n) {
+                random_limbs(a, 2 * n);
+                random_limbs(b, n);
+                np.resize(2 * n);
+                q.resize(n + 1);
+            }
+            bi::DIV_DC_THRESHOLD = on ? n : NEVER;
+        },
+        [&](uint32_t n) {
+            bi::mpn_copyi(np.data(), a.data(), 2 * n);
+            bi::mpn_div_qr(q.data(), np.data(), 2 * n, b.data(), n);
+        });
+    keep("BI_DIV_DC_THRESHOLD", bi::DIV_DC_THRESHOLD, t, 2, 1000);
+
+    // ---- Radix conversion ----
+
+    // to_string + from_string of an n-limb number, one D&C split on top of
+    // the base cases
+    bigint x;
+    std::string s;
+    t = crossover("RADIX_DC_THRESHOLD", 4, 400, 1.05,
+        [&](uint32_t n, bool on) {
+            random_limbs(a, n);
+            std::string hex;
+            char buf[17];
+            for (uint32_t i = n; i-- > 0;) {
+                snprintf(buf, sizeof buf, "%016llx", (unsigned long long)a[i]);
+                hex += buf;
+            }
+            x = bigint(hex, 16);
+            s = x.to_string();
+            bi::RADIX_DC_THRESHOLD = on ? n - 1 : NEVER;
+        },
+        [&](uint32_t) {
+            volatile size_t sink = x.to_string().size() + bigint(s).abs_size();
+            (void)sink;
+        });
+    keep("BI_RADIX_DC_THRESHOLD", bi::RADIX_DC_THRESHOLD, t == NEVER ? t : t - 1, 1, 400);
+
+    printf("#pragma once\n");
+    printf("// Generated by tune_bigint; see bigint/tuning.hpp.\n\n");
+    for (const Result& res : results)
+        printf("#define %-28s %u\n", res.macro, res.value);
+    return 0;
+}